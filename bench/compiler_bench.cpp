@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/compiler.hpp"
+#include "core/optimizer.hpp"
+#include "input_parser.hpp"
+#include "logger.hpp"
+#include "program_generators.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Median time of one pipeline phase for one program size, in milliseconds
+     *
+     * The parser pulls its tokens from the tokenizer as it goes, so `parse` is lexing and parsing
+     * together. `lex` times the tokenizer alone to show its share; it is part of `parse` and
+     * therefore not of the total.
+     */
+    struct PhaseTimes {
+        double preprocess = 0.0;
+        double lex = 0.0;
+        double parse = 0.0;
+        double codegen = 0.0;
+        double optimize = 0.0;
+
+        auto total() const -> double { return preprocess + parse + codegen + optimize; }
+    };
+
+    struct Sample {
+        size_t size;
+        size_t source_bytes;
+        PhaseTimes times;
+    };
+
+    template<typename Fn>
+    auto time_ms(Fn&& fn) -> double {
+        auto start = Clock::now();
+        fn();
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    auto median(std::vector<double> values) -> double {
+        if (values.empty()) {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    /**
+     * @brief Drive the tokenizer alone over a preprocessed program
+     */
+    auto count_tokens(const std::string& processed_program) -> size_t {
+        syntax::Tokenizer tokenizer;
+        tokenizer.initString(processed_program);
+
+        size_t tokens = 0;
+        while (tokenizer.getNextToken()->type != syntax::TokenType::__EOF) {
+            ++tokens;
+        }
+        return tokens;
+    }
+
+    /**
+     * @brief Measure every phase of one synthesized program
+     */
+    auto measure(const galluz::bench::SyntheticProgram& program,
+                 const fs::path& work_dir,
+                 size_t repetitions) -> PhaseTimes {
+        galluz::bench::write_module_files(program, work_dir);
+
+        std::vector<double> preprocess_ms;
+        std::vector<double> lex_ms;
+        std::vector<double> parse_ms;
+        std::vector<double> codegen_ms;
+        std::vector<double> optimize_ms;
+
+        for (size_t rep = 0; rep < repetitions; ++rep) {
+            // Every repetition pays for reading and parsing imports, as a fresh process would
+            galluz::core::ModuleCache::instance().clear();
+            galluz::Compiler compiler(work_dir.string());
+
+            std::string processed;
+            preprocess_ms.push_back(time_ms([&] { processed = compiler.preprocess(program.source); }));
+
+            lex_ms.push_back(time_ms([&] { count_tokens(processed); }));
+
+            Exp ast(std::vector<Exp>{});
+            parse_ms.push_back(time_ms([&] { ast = compiler.parse(processed); }));
+
+            codegen_ms.push_back(time_ms([&] { compiler.generate(ast); }));
+
+            optimize_ms.push_back(time_ms([&] { galluz::core::Optimizer().run(compiler.get_module()); }));
+        }
+
+        PhaseTimes times;
+        times.preprocess = median(preprocess_ms);
+        times.lex = median(lex_ms);
+        times.parse = median(parse_ms);
+        times.codegen = median(codegen_ms);
+        times.optimize = median(optimize_ms);
+        return times;
+    }
+
+    /**
+     * @brief Growth exponent k of t ~ n^k between two consecutive samples
+     */
+    auto scaling_exponent(double size_a, double time_a, double size_b, double time_b) -> double {
+        if (time_a <= 0.0 || time_b <= 0.0 || size_b <= size_a) {
+            return 0.0;
+        }
+        return std::log(time_b / time_a) / std::log(size_b / size_a);
+    }
+
+    auto print_report(const galluz::bench::Workload& workload, const std::vector<Sample>& samples, bool csv)
+        -> void {
+        if (csv) {
+            for (const auto& sample : samples) {
+                std::printf("%s,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                            workload.name.c_str(),
+                            sample.size,
+                            sample.source_bytes,
+                            sample.times.preprocess,
+                            sample.times.lex,
+                            sample.times.parse,
+                            sample.times.codegen,
+                            sample.times.optimize);
+            }
+            return;
+        }
+
+        std::printf("\n%s%s%s: %s\n", BOLD, workload.name.c_str(), RESET_STYLE, workload.description.c_str());
+        std::printf("%8s %10s %11s %9s %10s %9s %9s %9s %10s\n",
+                    "size",
+                    "bytes",
+                    "preprocess",
+                    "(lex)",
+                    "lex+parse",
+                    "codegen",
+                    "optimize",
+                    "total",
+                    "KiB/s");
+
+        for (const auto& sample : samples) {
+            const double total = sample.times.total();
+            const double kib = static_cast<double>(sample.source_bytes) / 1024.0;
+            const double throughput = total > 0.0 ? kib / (total / 1000.0) : 0.0;
+            std::printf("%8zu %10zu %9.2fms %7.2fms %8.2fms %7.2fms %7.2fms %7.2fms %10.1f\n",
+                        sample.size,
+                        sample.source_bytes,
+                        sample.times.preprocess,
+                        sample.times.lex,
+                        sample.times.parse,
+                        sample.times.codegen,
+                        sample.times.optimize,
+                        total,
+                        throughput);
+        }
+
+        if (samples.size() < 2) {
+            return;
+        }
+
+        struct PhaseColumn {
+            const char* name;
+            double PhaseTimes::*field;
+        };
+        const PhaseColumn columns[] = {{"preprocess", &PhaseTimes::preprocess},
+                                       {"lex", &PhaseTimes::lex},
+                                       {"lex+parse", &PhaseTimes::parse},
+                                       {"codegen", &PhaseTimes::codegen},
+                                       {"optimize", &PhaseTimes::optimize}};
+
+        std::printf("  scaling exponent (t ~ n^k) over %zu..%zu:", samples.front().size, samples.back().size);
+        for (const auto& column : columns) {
+            const auto& first = samples.front();
+            const auto& last = samples.back();
+            const double k = scaling_exponent(static_cast<double>(first.size),
+                                              first.times.*column.field,
+                                              static_cast<double>(last.size),
+                                              last.times.*column.field);
+            const bool superlinear = k > 1.3;
+            std::printf(" %s%s=%.2f%s", superlinear ? RED_COLOR : "", column.name, k, superlinear ? RESET_STYLE : "");
+        }
+        std::printf("\n");
+    }
+
+    auto parse_sizes(const std::string& list) -> std::vector<size_t> {
+        std::vector<size_t> sizes;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                sizes.push_back(std::stoul(item));
+            }
+        }
+        return sizes;
+    }
+}    // namespace
+
+auto main(int argc, char** argv) -> int {
+    InputParser parser(fs::path(argv[0]).filename().string(),
+                       "Galluz compiler throughput benchmark over synthesized programs");
+
+    parser.add_option({"-h", "--help", "Print this help message", false, ""});
+    parser.add_option({"-w", "--workload", "Run only this workload", true, "<name>"});
+    parser.add_option({"-s", "--sizes", "Comma-separated program sizes", true, "<n,n,...>"});
+    parser.add_option({"-r", "--repeat", "Repetitions per size (median is reported)", true, "<count>"});
+    parser.add_option({"-l", "--list", "List available workloads", false, ""});
+    parser.add_option({"-c", "--csv", "Print raw CSV instead of tables", false, ""});
+
+    if (!parser.parse(argc, argv)) {
+        for (const auto& error : parser.get_errors()) {
+            LOG_ERROR("%s", error.c_str());
+        }
+        std::cerr << parser.generate_help() << "\n";
+        return 1;
+    }
+
+    if (parser.has_option("-h")) {
+        std::cout << parser.generate_help() << "\n";
+        return 0;
+    }
+
+    auto workloads = galluz::bench::default_workloads();
+
+    if (parser.has_option("-l")) {
+        for (const auto& workload : workloads) {
+            std::printf("%-10s %s\n", workload.name.c_str(), workload.description.c_str());
+        }
+        return 0;
+    }
+
+    size_t repetitions = 3;
+    if (auto repeat = parser.get_argument("-r")) {
+        repetitions = std::max<size_t>(1, std::stoul(*repeat));
+    }
+
+    std::vector<size_t> custom_sizes;
+    if (auto sizes = parser.get_argument("-s")) {
+        custom_sizes = parse_sizes(*sizes);
+    }
+
+    const bool csv = parser.has_option("-c");
+    const auto only_workload = parser.get_argument("-w");
+
+    if (only_workload
+        && std::none_of(workloads.begin(),
+                        workloads.end(),
+                        [&](const galluz::bench::Workload& w) { return w.name == *only_workload; }))
+    {
+        LOG_ERROR("Unknown workload: %s", only_workload->c_str());
+        return 1;
+    }
+
+    const fs::path work_dir = fs::temp_directory_path() / "galluz_bench";
+    fs::create_directories(work_dir);
+
+    if (csv) {
+        std::printf("workload,size,bytes,preprocess_ms,lex_ms,lex_parse_ms,codegen_ms,optimize_ms\n");
+    }
+
+    for (const auto& workload : workloads) {
+        if (only_workload && workload.name != *only_workload) {
+            continue;
+        }
+
+        const auto& sizes = custom_sizes.empty() ? workload.default_sizes : custom_sizes;
+
+        std::vector<Sample> samples;
+        for (size_t size : sizes) {
+            auto program = workload.generate(size);
+            samples.push_back({size, program.source.size(), measure(program, work_dir, repetitions)});
+        }
+
+        print_report(workload, samples, csv);
+    }
+
+    fs::remove_all(work_dir);
+    return 0;
+}
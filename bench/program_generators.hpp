@@ -0,0 +1,183 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace galluz::bench {
+
+    /**
+     * @brief Synthesized galluz program
+     *
+     * `source` is the main program text. `module_files` holds extra files (relative path, contents)
+     * that must exist in the compiler's current directory for `import` to resolve them.
+     */
+    struct SyntheticProgram {
+        std::string source;
+        std::vector<std::pair<std::string, std::string>> module_files;
+    };
+
+    /**
+     * @brief Named program generator parameterized by size
+     */
+    struct Workload {
+        std::string name;
+        std::string description;
+        std::vector<size_t> default_sizes;
+        std::function<SyntheticProgram(size_t)> generate;
+    };
+
+    /**
+     * @brief N functions, each calling the previous one
+     */
+    inline auto generate_many_defns(size_t count) -> SyntheticProgram {
+        SyntheticProgram program;
+        std::string& src = program.source;
+
+        src += "(defn (f_0 !int) ((x !int) (y !int))\n    (+ x y))\n";
+        for (size_t i = 1; i < count; ++i) {
+            const std::string idx = std::to_string(i);
+            src += "(defn (f_" + idx + " !int) ((x !int) (y !int))\n";
+            src += "    (+ (f_" + std::to_string(i - 1) + " x y) (* x " + idx + ")))\n";
+        }
+
+        src += "(fprint \"%d\\n\" (f_" + std::to_string(count - 1) + " 1 2))\n";
+        return program;
+    }
+
+    /**
+     * @brief Nested if/do blocks of the given depth inside one function
+     */
+    inline auto generate_deep_nesting(size_t depth) -> SyntheticProgram {
+        SyntheticProgram program;
+        std::string& src = program.source;
+
+        src += "(defn (nested !int) ((x !int))\n (do (var (v !int) x)\n";
+        for (size_t i = 0; i < depth; ++i) {
+            src += std::string(i + 1, ' ') + "(if (> v " + std::to_string(i) + ") (do (set v (- v 1))\n";
+        }
+        src += std::string(depth + 1, ' ') + "v";
+        for (size_t i = 0; i < depth; ++i) {
+            src += ") 0)";
+        }
+        src += "))\n";
+
+        src += "(fprint \"%d\\n\" (nested " + std::to_string(depth * 2) + "))\n";
+        return program;
+    }
+
+    /**
+     * @brief One arithmetic list with N operands
+     */
+    inline auto generate_flat_list(size_t length) -> SyntheticProgram {
+        SyntheticProgram program;
+        std::string& src = program.source;
+
+        src += "(var (total !int) (+";
+        for (size_t i = 0; i < length; ++i) {
+            src += " " + std::to_string(i % 97);
+        }
+        src += "))\n";
+
+        src += "(fprint \"%d\\n\" total)\n";
+        return program;
+    }
+
+    /**
+     * @brief N distinct string literals
+     */
+    inline auto generate_string_literals(size_t count) -> SyntheticProgram {
+        SyntheticProgram program;
+        std::string& src = program.source;
+
+        for (size_t i = 0; i < count; ++i) {
+            const std::string idx = std::to_string(i);
+            src += "(var (s_" + idx + " !str) \"string literal number " + idx + "\")\n";
+        }
+
+        src += "(fprint \"%s\\n\" s_" + std::to_string(count - 1) + ")\n";
+        return program;
+    }
+
+    /**
+     * @brief One struct with N fields, instantiated and read field by field
+     */
+    inline auto generate_big_struct(size_t fields) -> SyntheticProgram {
+        SyntheticProgram program;
+        std::string& src = program.source;
+
+        src += "(struct Big (";
+        for (size_t i = 0; i < fields; ++i) {
+            const std::string idx = std::to_string(i);
+            src += (i % 2 == 0) ? "(f" + idx + " !int) " : "(f" + idx + " !double) ";
+        }
+        src += "))\n";
+
+        src += "(var (big !Big) (new Big";
+        for (size_t i = 0; i < fields; ++i) {
+            const std::string idx = std::to_string(i);
+            src += (i % 2 == 0) ? " (f" + idx + " " + idx + ")" : " (f" + idx + " " + idx + ".5)";
+        }
+        src += "))\n";
+
+        for (size_t i = 0; i < fields; i += 2) {
+            src += "(fprint \"%d\\n\" (getprop big f" + std::to_string(i) + "))\n";
+        }
+        return program;
+    }
+
+    /**
+     * @brief N module files imported into one program through ModuleManager
+     */
+    inline auto generate_wide_imports(size_t module_count) -> SyntheticProgram {
+        SyntheticProgram program;
+        std::string& src = program.source;
+
+        for (size_t i = 0; i < module_count; ++i) {
+            const std::string idx = std::to_string(i);
+            std::string module_src;
+            module_src += "(defmodule Mod" + idx + "\n";
+            module_src += "    (defn (mod" + idx + "_add !int) ((x !int) (y !int))\n";
+            module_src += "        (+ x y " + idx + "))\n";
+            module_src += "    (defn (mod" + idx + "_mul !int) ((x !int) (y !int))\n";
+            module_src += "        (* x y " + idx + "))\n";
+            module_src += ")\n";
+            program.module_files.emplace_back("bench_mod_" + idx + ".glz", module_src);
+
+            src += "(import \"bench_mod_" + idx + ".glz\" (module Mod" + idx + "))\n";
+        }
+
+        for (size_t i = 0; i < module_count; ++i) {
+            const std::string idx = std::to_string(i);
+            src += "(fprint \"%d\\n\" (Mod" + idx + ".mod" + idx + "_add 1 2))\n";
+        }
+        return program;
+    }
+
+    /**
+     * @brief All workloads known to the benchmark driver
+     */
+    inline auto default_workloads() -> std::vector<Workload> {
+        return {
+            {"defns", "many chained defn", {25, 50, 100, 200}, generate_many_defns},
+            {"nesting", "deeply nested if/do blocks", {10, 20, 40, 80}, generate_deep_nesting},
+            {"flat-list", "one arithmetic list with many operands", {125, 250, 500, 1000}, generate_flat_list},
+            {"strings", "many string literals", {50, 100, 200, 400}, generate_string_literals},
+            {"structs", "one struct with many fields", {8, 16, 32, 64}, generate_big_struct},
+            {"imports", "wide import graph through ModuleManager", {4, 8, 16, 32}, generate_wide_imports},
+        };
+    }
+
+    /**
+     * @brief Write the module files of a program into a directory
+     */
+    inline auto write_module_files(const SyntheticProgram& program, const std::filesystem::path& dir) -> void {
+        for (const auto& [name, content] : program.module_files) {
+            std::ofstream out(dir / name);
+            out << content;
+        }
+    }
+
+}    // namespace galluz::bench
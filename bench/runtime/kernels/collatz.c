@@ -0,0 +1,31 @@
+/* Reference for collatz.glz. */
+#include <stdio.h>
+
+static int collatz_steps(int start) {
+    int n = start;
+    int steps = 0;
+    while (n != 1) {
+        if (n % 2 == 0) {
+            n = n / 2;
+        } else {
+            n = 3 * n + 1;
+        }
+        steps = steps + 1;
+    }
+    return steps;
+}
+
+static int collatz_total(int limit, int rounds) {
+    int total = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (int k = 1; k < limit; k++) {
+            total = total + collatz_steps(k);
+        }
+    }
+    return total;
+}
+
+int main(void) {
+    printf("%d\n", collatz_total(99999, 5));
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* Reference for fannkuch-redux.glz: same permutation order, same checksum. */
+#include <stdio.h>
+#include <stdlib.h>
+
+static void fannkuch(int n) {
+    int* perm = calloc((size_t)n, sizeof(int));
+    int* perm1 = calloc((size_t)n, sizeof(int));
+    int* count = calloc((size_t)n, sizeof(int));
+    int max_flips = 0;
+    int checksum = 0;
+    int perm_count = 0;
+    int r = n;
+    int done = 0;
+    for (int i = 0; i < n; i++) {
+        perm1[i] = i;
+    }
+    while (!done) {
+        while (r != 1) {
+            count[r - 1] = r;
+            r = r - 1;
+        }
+        for (int i = 0; i < n; i++) {
+            perm[i] = perm1[i];
+        }
+        int flips = 0;
+        int k = perm[0];
+        while (k != 0) {
+            int i = 0;
+            int j = k;
+            while (i < j) {
+                int t = perm[i];
+                perm[i] = perm[j];
+                perm[j] = t;
+                i = i + 1;
+                j = j - 1;
+            }
+            flips = flips + 1;
+            k = perm[0];
+        }
+        if (flips > max_flips) {
+            max_flips = flips;
+        }
+        if (perm_count % 2 == 0) {
+            checksum = checksum + flips;
+        } else {
+            checksum = checksum - flips;
+        }
+        /* Next permutation: rotate the first r + 1 elements until a counter is left */
+        while (1) {
+            if (r == n) {
+                done = 1;
+                break;
+            }
+            int perm0 = perm1[0];
+            for (int i = 0; i < r; i++) {
+                perm1[i] = perm1[i + 1];
+            }
+            perm1[r] = perm0;
+            count[r] = count[r] - 1;
+            if (count[r] > 0) {
+                break;
+            }
+            r = r + 1;
+        }
+        perm_count = perm_count + 1;
+    }
+    free(perm);
+    free(perm1);
+    free(count);
+    printf("%d\nPfannkuchen(%d) = %d\n", checksum, n, max_flips);
+}
+
+int main(void) {
+    fannkuch(10);
+    return 0;
+}
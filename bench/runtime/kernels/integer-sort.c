@@ -0,0 +1,63 @@
+/* Reference for integer-sort.glz: same keys, same passes, same checksum. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void radix_pass(int n, const uint32_t* src, uint32_t* dst, int* counts, uint32_t shift) {
+    for (int d = 0; d < 256; d++) {
+        counts[d] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        int d = (int)((src[i] >> shift) % 256u);
+        counts[d] = counts[d] + 1;
+    }
+    int total = 0;
+    for (int d = 0; d < 256; d++) {
+        int count = counts[d];
+        counts[d] = total;
+        total = total + count;
+    }
+    for (int i = 0; i < n; i++) {
+        uint32_t key = src[i];
+        int d = (int)((key >> shift) % 256u);
+        int pos = counts[d];
+        dst[pos] = key;
+        counts[d] = pos + 1;
+    }
+}
+
+static void sort_rounds(int n, int rounds) {
+    uint32_t* keys = calloc((size_t)n, sizeof(uint32_t));
+    uint32_t* tmp = calloc((size_t)n, sizeof(uint32_t));
+    int* counts = calloc(256, sizeof(int));
+    uint32_t seed = 42u;
+    uint32_t checksum = 0u;
+    int unsorted = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            keys[i] = seed;
+        }
+        radix_pass(n, keys, tmp, counts, 0u);
+        radix_pass(n, tmp, keys, counts, 8u);
+        radix_pass(n, keys, tmp, counts, 16u);
+        radix_pass(n, tmp, keys, counts, 24u);
+        for (int i = 1; i < n; i++) {
+            if (keys[i - 1] > keys[i]) {
+                unsorted = unsorted + 1;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            checksum = checksum * 31u + keys[i];
+        }
+    }
+    free(keys);
+    free(tmp);
+    free(counts);
+    printf("%u %d\n", checksum, unsorted);
+}
+
+int main(void) {
+    sort_rounds(2000000, 10);
+    return 0;
+}
@@ -0,0 +1,34 @@
+/* Reference for mandelbrot.glz: same grid, same escape test, same iteration order. */
+#include <stdio.h>
+
+static int mandel_count(int size, int max_iter) {
+    int count = 0;
+    for (int py = 0; py < size; py++) {
+        double ci = (2.0 * py) / size - 1.0;
+        for (int px = 0; px < size; px++) {
+            double cr = (2.0 * px) / size - 1.5;
+            double zr = 0.0, zi = 0.0, zr2 = 0.0, zi2 = 0.0;
+            int inside = 1;
+            int i = 0;
+            while (i < max_iter) {
+                zi = 2.0 * zr * zi + ci;
+                zr = zr2 - zi2 + cr;
+                zr2 = zr * zr;
+                zi2 = zi * zi;
+                if (zr2 + zi2 > 4.0) {
+                    inside = 0;
+                    i = max_iter;
+                } else {
+                    i = i + 1;
+                }
+            }
+            count = count + inside;
+        }
+    }
+    return count;
+}
+
+int main(void) {
+    printf("%d\n", mandel_count(1200, 50));
+    return 0;
+}
@@ -0,0 +1,91 @@
+/* Reference for nbody.glz: same bodies, same operation order. */
+#include <math.h>
+#include <stdio.h>
+
+typedef struct {
+    double x, y, z, vx, vy, vz, mass;
+} Body;
+
+static void interact(Body* a, Body* b, double dt) {
+    double dx = a->x - b->x;
+    double dy = a->y - b->y;
+    double dz = a->z - b->z;
+    double d2 = dx * dx + dy * dy + dz * dz;
+    double mag = dt / (d2 * sqrt(d2));
+    double am = a->mass * mag;
+    double bm = b->mass * mag;
+    a->vx = a->vx - dx * bm;
+    a->vy = a->vy - dy * bm;
+    a->vz = a->vz - dz * bm;
+    b->vx = b->vx + dx * am;
+    b->vy = b->vy + dy * am;
+    b->vz = b->vz + dz * am;
+}
+
+static void move(Body* b, double dt) {
+    b->x = b->x + dt * b->vx;
+    b->y = b->y + dt * b->vy;
+    b->z = b->z + dt * b->vz;
+}
+
+static double kinetic(Body* b) {
+    return 0.5 * b->mass * (b->vx * b->vx + b->vy * b->vy + b->vz * b->vz);
+}
+
+static double potential(Body* a, Body* b) {
+    double dx = a->x - b->x;
+    double dy = a->y - b->y;
+    double dz = a->z - b->z;
+    return (a->mass * b->mass) / sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static void advance(Body* s, Body* j, Body* t, Body* u, Body* n, double dt) {
+    interact(s, j, dt); interact(s, t, dt); interact(s, u, dt); interact(s, n, dt);
+    interact(j, t, dt); interact(j, u, dt); interact(j, n, dt);
+    interact(t, u, dt); interact(t, n, dt);
+    interact(u, n, dt);
+    move(s, dt); move(j, dt); move(t, dt); move(u, dt); move(n, dt);
+}
+
+static double energy(Body* s, Body* j, Body* t, Body* u, Body* n) {
+    return (kinetic(s) + kinetic(j) + kinetic(t) + kinetic(u) + kinetic(n))
+         - (potential(s, j) + potential(s, t) + potential(s, u) + potential(s, n)
+            + potential(j, t) + potential(j, u) + potential(j, n)
+            + potential(t, u) + potential(t, n)
+            + potential(u, n));
+}
+
+int main(void) {
+    double solar_mass = 39.47841760435743;
+    double days = 365.24;
+
+    Body sun = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, solar_mass};
+    Body jupiter = {4.84143144246472090e+00, -1.16032004402742839e+00, -1.03622044471123109e-01,
+                    1.66007664274403694e-03 * days, 7.69901118419740425e-03 * days,
+                    -6.90460016972063023e-05 * days, 9.54791938424326609e-04 * solar_mass};
+    Body saturn = {8.34336671824457987e+00, 4.12479856412430479e+00, -4.03523417114321381e-01,
+                   -2.76742510726862411e-03 * days, 4.99852801234917238e-03 * days,
+                   2.30417297573763929e-05 * days, 2.85885980666130812e-04 * solar_mass};
+    Body uranus = {1.28943695621391310e+01, -1.51111514016986312e+01, -2.23307578892655734e-01,
+                   2.96460137564761618e-03 * days, 2.37847173959480950e-03 * days,
+                   -2.96589568540237556e-05 * days, 4.36624404335156298e-05 * solar_mass};
+    Body neptune = {1.53796971148509165e+01, -2.59193146099879641e+01, 1.79258772950371181e-01,
+                    2.68067772490389322e-03 * days, 1.62824170038242295e-03 * days,
+                    -9.51592254519715870e-05 * days, 5.15138902046611451e-05 * solar_mass};
+
+    sun.vx = (0.0 - (jupiter.vx * jupiter.mass + saturn.vx * saturn.mass + uranus.vx * uranus.mass
+                     + neptune.vx * neptune.mass)) / solar_mass;
+    sun.vy = (0.0 - (jupiter.vy * jupiter.mass + saturn.vy * saturn.mass + uranus.vy * uranus.mass
+                     + neptune.vy * neptune.mass)) / solar_mass;
+    sun.vz = (0.0 - (jupiter.vz * jupiter.mass + saturn.vz * saturn.mass + uranus.vz * uranus.mass
+                     + neptune.vz * neptune.mass)) / solar_mass;
+
+    printf("%.9f\n", energy(&sun, &jupiter, &saturn, &uranus, &neptune));
+
+    for (int step = 0; step < 5000000; step++) {
+        advance(&sun, &jupiter, &saturn, &uranus, &neptune, 0.01);
+    }
+
+    printf("%.9f\n", energy(&sun, &jupiter, &saturn, &uranus, &neptune));
+    return 0;
+}
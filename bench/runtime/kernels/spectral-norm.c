@@ -0,0 +1,61 @@
+/* Reference for spectral-norm.glz: same matrix, same summation order. */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static double a_elem(int i, int j) {
+    return 1.0 / ((i + j) * (i + j + 1) / 2 + i + 1);
+}
+
+static void mul_av(int n, const double* v, double* av) {
+    for (int i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (int j = 0; j < n; j++) {
+            sum = sum + a_elem(i, j) * v[j];
+        }
+        av[i] = sum;
+    }
+}
+
+static void mul_atv(int n, const double* v, double* atv) {
+    for (int i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (int j = 0; j < n; j++) {
+            sum = sum + a_elem(j, i) * v[j];
+        }
+        atv[i] = sum;
+    }
+}
+
+static void mul_atav(int n, const double* v, double* tmp, double* atav) {
+    mul_av(n, v, tmp);
+    mul_atv(n, tmp, atav);
+}
+
+static double spectral_norm(int n) {
+    double* u = calloc((size_t)n, sizeof(double));
+    double* v = calloc((size_t)n, sizeof(double));
+    double* tmp = calloc((size_t)n, sizeof(double));
+    for (int i = 0; i < n; i++) {
+        u[i] = 1.0;
+    }
+    for (int k = 0; k < 10; k++) {
+        mul_atav(n, u, tmp, v);
+        mul_atav(n, v, tmp, u);
+    }
+    double vbv = 0.0;
+    double vv = 0.0;
+    for (int i = 0; i < n; i++) {
+        vbv = vbv + u[i] * v[i];
+        vv = vv + v[i] * v[i];
+    }
+    free(u);
+    free(v);
+    free(tmp);
+    return sqrt(vbv / vv);
+}
+
+int main(void) {
+    printf("%.9f\n", spectral_norm(2000));
+    return 0;
+}
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""Runtime benchmark: compiled galluz kernels versus equivalent C programs.
+
+Every kernel in kernels.json has a `<name>.glz` and a `<name>.c` in kernels/.
+Both are compiled at their highest optimization level, run several times, and
+their outputs compared. The reported ratio is best(galluz) / best(C), the
+fastest run being the least disturbed by the rest of the machine;
+`--check` fails when a ratio regresses past the tolerance recorded in
+baseline.json, `--update-baseline` rewrites that file from the current run.
+"""
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent
+KERNELS_DIR = ROOT / "kernels"
+MANIFEST = ROOT / "kernels.json"
+BASELINE = ROOT / "baseline.json"
+
+BOLD = "\033[1m"
+RED = "\033[1;31m"
+GREEN = "\033[1;32m"
+YELLOW = "\033[1;33m"
+RESET = "\033[0m"
+
+
+def default_c_compiler():
+    if "CC" in os.environ:
+        return os.environ["CC"]
+    # galluzlang links through clang++, so prefer clang for the reference too
+    return "clang" if shutil.which("clang") else "cc"
+
+
+def compile_galluz(galluzlang, source, work_dir, name):
+    # galluzlang only accepts a bare output name, so run it inside the work dir
+    result = subprocess.run([galluzlang, "-f", str(source), "-o", name],
+                            cwd=work_dir, capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(f"galluzlang failed on {source.name}:\n{result.stdout}{result.stderr}")
+    return work_dir / name
+
+
+def compile_c(cc, source, work_dir, name):
+    output = work_dir / name
+    result = subprocess.run([cc, "-O3", str(source), "-o", str(output), "-lm"],
+                            capture_output=True, text=True)
+    if result.returncode != 0:
+        raise RuntimeError(f"{cc} failed on {source.name}:\n{result.stderr}")
+    return output
+
+
+def time_binary(binary, runs):
+    """Run a binary `runs` times, return (fastest run in seconds, stdout of the first run)."""
+    times = []
+    output = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        result = subprocess.run([str(binary)], capture_output=True, text=True)
+        times.append(time.perf_counter() - start)
+        if result.returncode != 0:
+            raise RuntimeError(f"{binary.name} exited with {result.returncode}")
+        if output is None:
+            output = result.stdout
+    return min(times), output
+
+
+def load_json(path, default):
+    if not path.exists():
+        return default
+    with open(path) as f:
+        return json.load(f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Galluz runtime benchmark versus C baselines")
+    parser.add_argument("--galluzlang", default=str(ROOT.parents[1] / "build" / "bin" / "galluzlang"),
+                        help="path to the galluzlang compiler")
+    parser.add_argument("--cc", default=default_c_compiler(), help="C compiler for the reference programs")
+    parser.add_argument("--runs", type=int, default=5, help="runs per binary (the fastest is reported)")
+    parser.add_argument("--kernel", action="append", help="run only this kernel (repeatable)")
+    parser.add_argument("--check", action="store_true", help="fail when a ratio regresses past the baseline")
+    parser.add_argument("--update-baseline", action="store_true", help="rewrite baseline.json from this run")
+    parser.add_argument("--json", help="also write the results to this file")
+    args = parser.parse_args()
+
+    galluzlang = Path(args.galluzlang).resolve()
+    if not os.access(galluzlang, os.X_OK):
+        print(f"Error: galluzlang compiler not found at {galluzlang}", file=sys.stderr)
+        return 1
+
+    manifest = load_json(MANIFEST, {"kernels": []})
+    baseline = load_json(BASELINE, {"tolerance": 0.20, "ratios": {}})
+    tolerance = baseline.get("tolerance", 0.20)
+
+    kernels = manifest["kernels"]
+    if args.kernel:
+        kernels = [k for k in kernels if k["name"] in args.kernel]
+
+    print(f"{BOLD}{'kernel':<14} {'galluz':>10} {'C':>10} {'ratio':>7} {'baseline':>9}{RESET}")
+
+    results = {}
+    failed = False
+    with tempfile.TemporaryDirectory(prefix="galluz_runtime_") as tmp:
+        work_dir = Path(tmp)
+        for kernel in kernels:
+            name = kernel["name"]
+            if "pending" in kernel:
+                print(f"{name:<14} {YELLOW}skipped{RESET}: {kernel['pending']}")
+                continue
+
+            try:
+                glz_bin = compile_galluz(galluzlang, KERNELS_DIR / f"{name}.glz", work_dir, f"{name}_glz")
+                c_bin = compile_c(args.cc, KERNELS_DIR / f"{name}.c", work_dir, f"{name}_c")
+                glz_time, glz_out = time_binary(glz_bin, args.runs)
+                c_time, c_out = time_binary(c_bin, args.runs)
+            except RuntimeError as error:
+                print(f"{name:<14} {RED}error{RESET}: {error}")
+                failed = True
+                continue
+
+            if glz_out != c_out:
+                print(f"{name:<14} {RED}output mismatch{RESET}: galluz {glz_out.strip()!r} vs C {c_out.strip()!r}")
+                failed = True
+                continue
+
+            ratio = glz_time / c_time if c_time > 0 else float("inf")
+            results[name] = {"galluz_s": glz_time, "c_s": c_time, "ratio": ratio}
+
+            expected = baseline["ratios"].get(name)
+            status = ""
+            if expected is not None:
+                if ratio > expected * (1.0 + tolerance):
+                    status = f" {RED}regressed{RESET}"
+                    failed = failed or args.check
+                elif ratio < expected * (1.0 - tolerance):
+                    status = f" {GREEN}improved{RESET}"
+            expected_text = f"{expected:.2f}" if expected is not None else "-"
+
+            print(f"{name:<14} {glz_time * 1000:>8.1f}ms {c_time * 1000:>8.1f}ms "
+                  f"{ratio:>7.2f} {expected_text:>9}{status}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=2)
+
+    if args.update_baseline:
+        baseline["ratios"].update({name: round(r["ratio"], 2) for name, r in results.items()})
+        with open(BASELINE, "w") as f:
+            json.dump(baseline, f, indent=2)
+            f.write("\n")
+        print(f"Baseline written to {BASELINE}")
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
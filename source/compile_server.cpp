@@ -0,0 +1,202 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "compile_server.hpp"
+
+#include "logger.hpp"
+
+namespace galluz {
+
+    namespace {
+        /// Framing: every string is a 32-bit length followed by its bytes
+        constexpr uint32_t MAX_FIELD_SIZE = 64U * 1024U * 1024U;
+
+        char g_socket_path[sizeof(sockaddr_un::sun_path)] = {};
+
+        void handle_shutdown_signal(int /*signal*/) {
+            ::unlink(g_socket_path);
+            ::_exit(0);
+        }
+
+        auto write_all(int fd, const void* data, size_t size) -> bool {
+            const auto* bytes = static_cast<const char*>(data);
+            while (size > 0) {
+                ssize_t written = ::write(fd, bytes, size);
+                if (written <= 0) {
+                    return false;
+                }
+                bytes += written;
+                size -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+
+        auto read_all(int fd, void* data, size_t size) -> bool {
+            auto* bytes = static_cast<char*>(data);
+            while (size > 0) {
+                ssize_t received = ::read(fd, bytes, size);
+                if (received <= 0) {
+                    return false;
+                }
+                bytes += received;
+                size -= static_cast<size_t>(received);
+            }
+            return true;
+        }
+
+        auto write_u32(int fd, uint32_t value) -> bool { return write_all(fd, &value, sizeof(value)); }
+
+        auto read_u32(int fd, uint32_t& value) -> bool { return read_all(fd, &value, sizeof(value)); }
+
+        auto write_string(int fd, const std::string& text) -> bool {
+            return write_u32(fd, static_cast<uint32_t>(text.size()))
+                && write_all(fd, text.data(), text.size());
+        }
+
+        auto read_string(int fd, std::string& text) -> bool {
+            uint32_t size = 0;
+            if (!read_u32(fd, size) || size > MAX_FIELD_SIZE) {
+                return false;
+            }
+            text.resize(size);
+            return read_all(fd, text.data(), size);
+        }
+
+        auto make_address(const std::string& socket_path, sockaddr_un& address) -> bool {
+            if (socket_path.size() >= sizeof(address.sun_path)) {
+                LOG_ERROR("Socket path too long: %s", socket_path.c_str());
+                return false;
+            }
+            std::memset(&address, 0, sizeof(address));
+            address.sun_family = AF_UNIX;
+            std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+            return true;
+        }
+    }    // namespace
+
+    CompileServer::CompileServer(std::string socket_path, CompileHandler handler)
+        : m_SOCKET_PATH(std::move(socket_path))
+        , m_HANDLER(std::move(handler)) {}
+
+    auto CompileServer::run() -> int {
+        sockaddr_un address {};
+        if (!make_address(m_SOCKET_PATH, address)) {
+            return 1;
+        }
+
+        int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            LOG_ERROR("Cannot create socket: %s", std::strerror(errno));
+            return 1;
+        }
+
+        // A socket file left behind by a killed server would make bind fail
+        ::unlink(m_SOCKET_PATH.c_str());
+        if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || ::listen(listen_fd, SOMAXCONN) != 0)
+        {
+            LOG_ERROR("Cannot listen on \"%s\": %s", m_SOCKET_PATH.c_str(), std::strerror(errno));
+            ::close(listen_fd);
+            return 1;
+        }
+
+        std::strncpy(g_socket_path, m_SOCKET_PATH.c_str(), sizeof(g_socket_path) - 1);
+        std::signal(SIGINT, handle_shutdown_signal);
+        std::signal(SIGTERM, handle_shutdown_signal);
+        std::signal(SIGPIPE, SIG_IGN);
+
+        LOG_INFO("Compile server listening on %s", m_SOCKET_PATH.c_str());
+
+        while (true) {
+            int connection_fd = ::accept(listen_fd, nullptr, nullptr);
+            if (connection_fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR("accept failed: %s", std::strerror(errno));
+                break;
+            }
+
+            std::thread([this, connection_fd]() { serve_connection(connection_fd); }).detach();
+        }
+
+        ::close(listen_fd);
+        ::unlink(m_SOCKET_PATH.c_str());
+        return 1;
+    }
+
+    auto CompileServer::serve_connection(int connection_fd) -> void {
+        CompileRequest request;
+        uint32_t arg_count = 0;
+
+        bool valid = read_string(connection_fd, request.working_directory)
+            && read_u32(connection_fd, arg_count) && arg_count < MAX_FIELD_SIZE;
+        for (uint32_t i = 0; valid && i < arg_count; ++i) {
+            request.args.emplace_back();
+            valid = read_string(connection_fd, request.args.back());
+        }
+
+        if (!valid) {
+            LOG_WARN("Dropped malformed request");
+            ::close(connection_fd);
+            return;
+        }
+
+        std::string output;
+        int exit_code = 1;
+        try {
+            exit_code = m_HANDLER(request, output);
+        } catch (const std::exception& e) {
+            output += std::string("Request failed: ") + e.what() + "\n";
+        }
+
+        write_u32(connection_fd, static_cast<uint32_t>(exit_code));
+        write_string(connection_fd, output);
+        ::close(connection_fd);
+    }
+
+    auto forward_to_server(const std::string& socket_path, const CompileRequest& request)
+        -> std::optional<int> {
+        sockaddr_un address {};
+        if (!make_address(socket_path, address)) {
+            return std::nullopt;
+        }
+
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return std::nullopt;
+        }
+
+        bool sent = write_string(fd, request.working_directory)
+            && write_u32(fd, static_cast<uint32_t>(request.args.size()));
+        for (const auto& arg : request.args) {
+            sent = sent && write_string(fd, arg);
+        }
+
+        uint32_t exit_code = 0;
+        std::string output;
+        bool received = sent && read_u32(fd, exit_code) && read_string(fd, output);
+        ::close(fd);
+
+        if (!received) {
+            return std::nullopt;
+        }
+
+        std::fwrite(output.data(), 1, output.size(), stdout);
+        std::fflush(stdout);
+        return static_cast<int>(exit_code);
+    }
+
+}    // namespace galluz
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace galluz {
+
+    /**
+     * @brief One forwarded command line
+     */
+    struct CompileRequest {
+        std::string working_directory;    ///< Directory relative paths of the request are resolved against
+        std::vector<std::string> args;    ///< Command line without the program name
+    };
+
+    /**
+     * @brief Runs a request and returns its exit code, appending everything it logs to output
+     */
+    using CompileHandler = std::function<int(const CompileRequest& request, std::string& output)>;
+
+    /**
+     * @brief Compile daemon listening on a Unix domain socket
+     *
+     * Every connection carries one request and is served on its own thread, so independent
+     * compilations run concurrently and share whatever process-wide state the handler keeps warm.
+     */
+    class CompileServer {
+      public:
+        /**
+         * @brief Construct a new Compile Server object
+         *
+         * @param socket_path Filesystem path of the socket to create
+         * @param handler Called concurrently, once per request
+         */
+        CompileServer(std::string socket_path, CompileHandler handler);
+
+        /**
+         * @brief Accept and serve requests until the process receives SIGINT or SIGTERM
+         *
+         * @return int Process exit code
+         */
+        auto run() -> int;
+
+      private:
+        std::string m_SOCKET_PATH;
+        CompileHandler m_HANDLER;
+
+        auto serve_connection(int connection_fd) -> void;
+    };
+
+    /**
+     * @brief Send a request to a running server and print its output
+     *
+     * @param socket_path Socket the server listens on
+     * @param request Command line to forward
+     * @return std::optional<int> The request's exit code, or nothing if no server answered
+     */
+    auto forward_to_server(const std::string& socket_path, const CompileRequest& request)
+        -> std::optional<int>;
+
+}    // namespace galluz
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <llvm/Analysis/CFG.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+namespace galluz::core {
+
+    /**
+     * @brief Frontend analysis that attaches function facts LLVM cannot always prove itself
+     *
+     * Galluz has no exceptions, no pointer arithmetic and no way to take the address of a function,
+     * so after codegen every `defn` is fully described by its body and its call sites:
+     *
+     *  - `internal` + `fastcc` for functions that are neither `main` nor exported from a module;
+     *  - `nounwind` on every defined function;
+     *  - `readnone` / `readonly` when the body (transitively) only touches its own stack;
+     *  - `willreturn` when the body has no loop and only calls functions that return;
+     *  - `noalias` on struct-pointer parameters of internal functions when every call site passes
+     *    distinct identified objects (caller allocas or caller `noalias` parameters).
+     */
+    class AttributeInference {
+      private:
+        enum class MemoryEffect : uint8_t
+        {
+            NONE,
+            READ,
+            WRITE
+        };
+
+        std::unordered_set<std::string> m_EXPORTED;
+        bool m_INTERNALIZE;
+
+        static auto is_local_object(const llvm::Value* ptr) -> bool {
+            return llvm::isa<llvm::AllocaInst>(llvm::getUnderlyingObject(ptr));
+        }
+
+        static auto direct_callers_only(const llvm::Function& func) -> bool {
+            for (const auto* user : func.users()) {
+                const auto* call = llvm::dyn_cast<llvm::CallBase>(user);
+                if (!call || call->getCalledFunction() != &func) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static auto defined_functions(llvm::Module& module) -> std::vector<llvm::Function*> {
+            std::vector<llvm::Function*> functions;
+            for (auto& func : module) {
+                if (!func.isDeclaration()) {
+                    functions.push_back(&func);
+                }
+            }
+            return functions;
+        }
+
+        auto internalize(const std::vector<llvm::Function*>& functions) -> void {
+            std::unordered_set<llvm::Function*> candidates;
+            for (auto* func : functions) {
+                if (func->getName() != "main" && !m_EXPORTED.count(func->getName().str())
+                    && direct_callers_only(*func))
+                {
+                    candidates.insert(func);
+                }
+            }
+
+            // musttail needs matching conventions: both ends of such a call switch to fastcc or neither
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto* func : functions) {
+                    for (auto& inst : llvm::instructions(*func)) {
+                        auto* call = llvm::dyn_cast<llvm::CallInst>(&inst);
+                        if (!call || !call->isMustTailCall()) {
+                            continue;
+                        }
+
+                        auto* callee = call->getCalledFunction();
+                        if (candidates.count(func) != candidates.count(callee)) {
+                            candidates.erase(func);
+                            candidates.erase(callee);
+                            changed = true;
+                        }
+                    }
+                }
+            }
+
+            for (auto* func : functions) {
+                if (func->getName() == "main" || m_EXPORTED.count(func->getName().str())) {
+                    continue;
+                }
+
+                func->setLinkage(llvm::GlobalValue::InternalLinkage);
+                if (!candidates.count(func)) {
+                    continue;
+                }
+
+                func->setCallingConv(llvm::CallingConv::Fast);
+                for (auto* user : func->users()) {
+                    llvm::cast<llvm::CallBase>(user)->setCallingConv(llvm::CallingConv::Fast);
+                }
+            }
+        }
+
+        static auto infer_memory_effects(const std::vector<llvm::Function*>& functions) -> void {
+            std::unordered_map<const llvm::Function*, MemoryEffect> effects;
+            for (auto* func : functions) {
+                effects[func] = MemoryEffect::NONE;
+            }
+
+            // Optimistic fixpoint: effects only grow, so recursion converges to the smallest sound answer
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto* func : functions) {
+                    MemoryEffect effect = MemoryEffect::NONE;
+                    for (auto& inst : llvm::instructions(*func)) {
+                        MemoryEffect inst_effect = MemoryEffect::NONE;
+
+                        if (auto* load = llvm::dyn_cast<llvm::LoadInst>(&inst)) {
+                            if (!is_local_object(load->getPointerOperand())) {
+                                inst_effect = MemoryEffect::READ;
+                            }
+                        } else if (auto* store = llvm::dyn_cast<llvm::StoreInst>(&inst)) {
+                            if (!is_local_object(store->getPointerOperand())) {
+                                inst_effect = MemoryEffect::WRITE;
+                            }
+                        } else if (auto* call = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+                            auto* callee = call->getCalledFunction();
+                            auto it = callee ? effects.find(callee) : effects.end();
+                            inst_effect = it != effects.end() ? it->second : MemoryEffect::WRITE;
+                        } else if (inst.mayReadOrWriteMemory()) {
+                            inst_effect = MemoryEffect::WRITE;
+                        }
+
+                        effect = std::max(effect, inst_effect);
+                    }
+
+                    if (effect > effects[func]) {
+                        effects[func] = effect;
+                        changed = true;
+                    }
+                }
+            }
+
+            for (auto* func : functions) {
+                if (effects[func] == MemoryEffect::NONE) {
+                    func->setDoesNotAccessMemory();
+                } else if (effects[func] == MemoryEffect::READ) {
+                    func->setOnlyReadsMemory();
+                }
+            }
+        }
+
+        static auto infer_will_return(const std::vector<llvm::Function*>& functions) -> void {
+            std::unordered_set<const llvm::Function*> loop_free;
+            for (auto* func : functions) {
+                llvm::SmallVector<std::pair<const llvm::BasicBlock*, const llvm::BasicBlock*>, 4> backedges;
+                llvm::FindFunctionBackedges(*func, backedges);
+                if (backedges.empty()) {
+                    loop_free.insert(func);
+                }
+            }
+
+            // Pessimistic fixpoint: a function is marked only after all of its callees are
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto* func : functions) {
+                    if (func->hasFnAttribute(llvm::Attribute::WillReturn) || !loop_free.count(func)) {
+                        continue;
+                    }
+
+                    bool returns = true;
+                    for (auto& inst : llvm::instructions(*func)) {
+                        if (auto* call = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+                            auto* callee = call->getCalledFunction();
+                            if (!callee || !callee->hasFnAttribute(llvm::Attribute::WillReturn)) {
+                                returns = false;
+                                break;
+                            }
+                        }
+                    }
+
+                    if (returns) {
+                        func->addFnAttr(llvm::Attribute::WillReturn);
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        static auto is_identified_object(const llvm::Value* object) -> bool {
+            if (llvm::isa<llvm::AllocaInst>(object)) {
+                return true;
+            }
+            if (const auto* arg = llvm::dyn_cast<llvm::Argument>(object)) {
+                return arg->hasNoAliasAttr();
+            }
+            return false;
+        }
+
+        static auto infer_noalias(const std::vector<llvm::Function*>& functions) -> void {
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (auto* func : functions) {
+                    if (!func->hasLocalLinkage() || func->use_empty() || !direct_callers_only(*func)) {
+                        continue;
+                    }
+
+                    for (auto& arg : func->args()) {
+                        if (!arg.getType()->isPointerTy() || arg.hasNoAliasAttr()) {
+                            continue;
+                        }
+
+                        bool distinct = true;
+                        for (auto* user : func->users()) {
+                            auto* call = llvm::cast<llvm::CallBase>(user);
+                            const auto* object =
+                                llvm::getUnderlyingObject(call->getArgOperand(arg.getArgNo()));
+                            if (!is_identified_object(object)) {
+                                distinct = false;
+                                break;
+                            }
+
+                            for (unsigned i = 0; i < call->arg_size(); ++i) {
+                                if (i != arg.getArgNo() && call->getArgOperand(i)->getType()->isPointerTy()
+                                    && llvm::getUnderlyingObject(call->getArgOperand(i)) == object)
+                                {
+                                    distinct = false;
+                                    break;
+                                }
+                            }
+                            if (!distinct) {
+                                break;
+                            }
+                        }
+
+                        if (distinct) {
+                            arg.addAttr(llvm::Attribute::NoAlias);
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+      public:
+        explicit AttributeInference(std::unordered_set<std::string> exported = {}, bool internalize = true)
+            : m_EXPORTED(std::move(exported))
+            , m_INTERNALIZE(internalize) {}
+
+        auto run(llvm::Module& module) -> void {
+            auto functions = defined_functions(module);
+
+            if (m_INTERNALIZE) {
+                internalize(functions);
+            }
+
+            for (auto* func : functions) {
+                func->setDoesNotThrow();
+            }
+
+            infer_memory_effects(functions);
+            infer_will_return(functions);
+            infer_noalias(functions);
+        }
+    };
+
+}    // namespace galluz::core
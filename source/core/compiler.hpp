@@ -5,9 +5,11 @@
 
 #include <llvm/IR/Verifier.h>
 
+#include "attribute_inference.hpp"
 #include "generator_factory.hpp"
 #include "generator_manager.hpp"
 #include "module_manager.hpp"
+#include "optimizer.hpp"
 #include "preprocessor.hpp"
 #include "types.hpp"
 
@@ -15,7 +17,8 @@ namespace galluz {
 
     class Compiler {
       private:
-        std::unique_ptr<llvm::LLVMContext> m_CTX;
+        std::unique_ptr<llvm::LLVMContext> m_OWNED_CTX;
+        llvm::LLVMContext* m_CTX = nullptr;
         std::unique_ptr<llvm::Module> m_MODULE;
         std::unique_ptr<llvm::IRBuilder<>> m_BUILDER;
         std::unique_ptr<syntax::GalluzGrammar> m_PARSER;
@@ -25,29 +28,77 @@ namespace galluz {
         std::unique_ptr<core::TypeSystem> m_TYPE_SYSTEM;
         std::unique_ptr<core::ModuleManager> m_MODULE_MANAGER;
         std::string m_CURRENT_DIRECTORY;
+        bool m_LIBRARY_MODE = false;
 
       public:
-        Compiler(const std::string& current_dir = "")
-            : m_PARSER(std::make_unique<syntax::GalluzGrammar>())
+        /**
+         * @param shared_ctx LLVM context to generate into instead of a private one (e.g. the JIT's)
+         */
+        Compiler(const std::string& current_dir = "", llvm::LLVMContext* shared_ctx = nullptr)
+            : m_CTX(shared_ctx)
+            , m_PARSER(std::make_unique<syntax::GalluzGrammar>())
             , m_CURRENT_DIRECTORY(current_dir) {
             initialize_llvm();
             setup_external_functions();
         }
 
         auto execute(const std::string& program, const std::string& output_base) -> int {
-            std::string processed_program = m_PREPROCESSOR.preprocess(program);
+            std::string processed_program = preprocess(program);
 
-            auto ast = m_PARSER->parse(processed_program);
+            auto ast = parse(processed_program);
 
-            generate_ir(ast);
-
-            llvm::verifyModule(*m_MODULE, &llvm::errs());
+            generate(ast);
 
             save_module_to_file(output_base + ".ll");
 
             return 0;
         }
 
+        auto preprocess(const std::string& program) -> std::string {
+            return m_PREPROCESSOR.preprocess(program);
+        }
+
+        auto parse(const std::string& processed_program) -> Exp { return m_PARSER->parse(processed_program); }
+
+        auto generate(const Exp& ast) -> void {
+            generate_ir(ast);
+            if (m_LIBRARY_MODE) {
+                // A library exports every function of its modules, referenced or not
+                m_MODULE_MANAGER->materialize_all(*m_COMPILATION_CONTEXT);
+            }
+            m_MODULE_MANAGER->discard_unused_functions(*m_COMPILATION_CONTEXT);
+
+            // Invalid IR must not reach the optimizer, the backend or the JIT
+            if (llvm::verifyModule(*m_MODULE, &llvm::errs())) {
+                LOG_CRITICAL("Generated code is invalid");
+            }
+
+            core::AttributeInference(m_MODULE_MANAGER->get_exported_symbols()).run(*m_MODULE);
+        }
+
+        auto get_module() -> llvm::Module& { return *m_MODULE; }
+
+        /**
+         * @brief Hand the generated module over, e.g. to a JIT; nothing can be generated afterwards
+         */
+        auto release_module() -> std::unique_ptr<llvm::Module> { return std::move(m_MODULE); }
+
+        auto get_compilation_context() -> core::CompilationContext& { return *m_COMPILATION_CONTEXT; }
+
+        auto get_generator_manager() -> core::GeneratorManager& { return m_GENERATOR_MANAGER; }
+
+        auto get_module_manager() -> core::ModuleManager& { return *m_MODULE_MANAGER; }
+
+        auto set_library_mode(bool enabled) -> void { m_LIBRARY_MODE = enabled; }
+
+        auto set_assume_no_signed_wrap(bool enabled) -> void {
+            m_COMPILATION_CONTEXT->assume_no_signed_wrap = enabled;
+        }
+
+        auto set_report_struct_layout(bool enabled) -> void {
+            m_COMPILATION_CONTEXT->report_struct_layout = enabled;
+        }
+
         auto set_current_directory(const std::string& dir) -> void {
             m_CURRENT_DIRECTORY = dir;
             if (m_MODULE_MANAGER) {
@@ -57,8 +108,13 @@ namespace galluz {
 
       private:
         void initialize_llvm() {
-            m_CTX = std::make_unique<llvm::LLVMContext>();
+            if (!m_CTX) {
+                m_OWNED_CTX = std::make_unique<llvm::LLVMContext>();
+                m_CTX = m_OWNED_CTX.get();
+            }
             m_MODULE = std::make_unique<llvm::Module>("GalluzLangCompilationUnit", *m_CTX);
+            // Struct layout and alignments are decided during generation
+            m_MODULE->setDataLayout(core::Optimizer::host_data_layout());
             m_BUILDER = std::make_unique<llvm::IRBuilder<>>(*m_CTX);
 
             m_TYPE_SYSTEM = std::make_unique<core::TypeSystem>(*m_CTX);
@@ -75,6 +131,8 @@ namespace galluz {
             m_TYPE_SYSTEM->register_type("bool", core::TypeKind::BOOL, m_BUILDER->getInt1Ty());
             m_TYPE_SYSTEM->register_type("void", core::TypeKind::VOID, m_BUILDER->getVoidTy());
             m_TYPE_SYSTEM->register_type("auto", core::TypeKind::UNKNOWN, nullptr);
+            m_TYPE_SYSTEM->register_sized_types();
+            m_TYPE_SYSTEM->register_vector_types();
 
             m_COMPILATION_CONTEXT = std::make_unique<core::CompilationContext>(
                 *m_CTX, *m_MODULE, *m_BUILDER, nullptr, m_TYPE_SYSTEM.get());
@@ -152,7 +210,7 @@ namespace galluz {
             m_MODULE->getOrInsertGlobal(name, init_value->getType());
             auto* variable = m_MODULE->getNamedGlobal(name);
 
-            variable->setAlignment(llvm::MaybeAlign(4));
+            variable->setAlignment(m_MODULE->getDataLayout().getABITypeAlign(init_value->getType()));
             variable->setConstant(!is_mutable);
             variable->setInitializer(init_value);
 
@@ -1,15 +1,19 @@
 #pragma once
 
 #include "../generators/arithmetic_generator.hpp"
+#include "../generators/cast_generator.hpp"
 #include "../generators/comparison_generator.hpp"
 #include "../generators/control_flow_generator.hpp"
 #include "../generators/do_generator.hpp"
+#include "../generators/extern_generator.hpp"
 #include "../generators/finput_generator.hpp"
 #include "../generators/fractional_generator.hpp"
 #include "../generators/function_call_generator.hpp"
 #include "../generators/function_generator.hpp"
 #include "../generators/import_generator.hpp"
 #include "../generators/list_generator.hpp"
+#include "../generators/logical_generator.hpp"
+#include "../generators/math_generator.hpp"
 #include "../generators/module_generator.hpp"
 #include "../generators/moduleuse_generator.hpp"
 #include "../generators/new_generator.hpp"
@@ -18,10 +22,12 @@
 #include "../generators/property_generator.hpp"
 #include "../generators/scope_generator.hpp"
 #include "../generators/set_generator.hpp"
+#include "../generators/soa_generator.hpp"
 #include "../generators/string_generator.hpp"
 #include "../generators/struct_generator.hpp"
 #include "../generators/symbol_generator.hpp"
 #include "../generators/variable_generator.hpp"
+#include "../generators/vector_generator.hpp"
 #include "generator_manager.hpp"
 #include "module_manager.hpp"
 
@@ -45,6 +51,10 @@ namespace galluz::core {
             manager.register_generator(std::make_unique<generators::DoGenerator>(&manager));
             manager.register_generator(std::make_unique<generators::ArithmeticGenerator>(&manager));
             manager.register_generator(std::make_unique<generators::ComparisonGenerator>(&manager));
+            manager.register_generator(std::make_unique<generators::LogicalGenerator>(&manager));
+            manager.register_generator(std::make_unique<generators::VectorGenerator>(&manager));
+            manager.register_generator(std::make_unique<generators::MathGenerator>(&manager));
+            manager.register_generator(std::make_unique<generators::CastGenerator>(&manager));
             manager.register_generator(std::make_unique<generators::PrintGenerator>(&manager));
             manager.register_generator(std::make_unique<generators::FinputGenerator>(&manager));
             manager.register_generator(std::make_unique<generators::ListGenerator>(&manager));
@@ -53,8 +63,10 @@ namespace galluz::core {
             manager.register_generator(
                 std::make_unique<generators::FunctionCallGenerator>(&manager, module_manager));
             manager.register_generator(std::make_unique<generators::StructGenerator>(&manager));
+            manager.register_generator(std::make_unique<generators::ExternGenerator>());
             manager.register_generator(std::make_unique<generators::NewGenerator>(&manager));
             manager.register_generator(std::make_unique<generators::PropertyGenerator>(&manager));
+            manager.register_generator(std::make_unique<generators::SoaGenerator>(&manager));
             manager.register_generator(
                 std::make_unique<generators::ModuleGenerator>(&manager, module_manager));
             manager.register_generator(
@@ -57,6 +57,24 @@ namespace galluz::core {
             return generator->generate(ast_node, context);
         }
 
+        /**
+         * @brief Run the declaration passes over `forms[first..]`, the body of one block
+         */
+        auto declare_forms(const std::vector<Exp>& forms, size_t first, CompilationContext& context) -> void {
+            for (auto pass :
+                 {DeclarationPass::TYPES, DeclarationPass::SIGNATURES, DeclarationPass::INFERRED_SIGNATURES})
+            {
+                for (size_t i = first; i < forms.size(); ++i) {
+                    for (const auto& generator : m_GENERATORS) {
+                        if (generator->can_handle(forms[i])) {
+                            generator->declare(forms[i], context, pass);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
         auto has_generator_for(const Exp& ast_node) const -> bool {
             for (const auto& generator : m_GENERATORS) {
                 if (generator->can_handle(ast_node)) {
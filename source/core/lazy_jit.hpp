@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/TargetSelect.h>
+
+#include "../logger.hpp"
+#include "compiler.hpp"
+#include "optimizer.hpp"
+
+namespace galluz {
+
+    /**
+     * @brief Runs a program in-process, compiling each function only when it is first called
+     *
+     * The generated module goes to an LLLazyJIT unoptimized. Its CompileOnDemandLayer replaces every
+     * function with a stub. On the first call through a stub, the function is extracted into a
+     * partition together with the functions it calls, optimized, compiled and patched in.
+     * Functions the run never reaches are never optimized or compiled. With compile threads,
+     * partitions are compiled off the thread that hit the stub.
+     */
+    class LazyJit {
+      private:
+        llvm::orc::ThreadSafeContext m_TS_CTX;
+        std::unique_ptr<llvm::orc::LLLazyJIT> m_JIT;
+        core::Optimizer m_OPTIMIZER;
+        std::mutex m_OPTIMIZER_MUTEX;
+
+        /// Callees up to this many (unoptimized) instructions join their caller's partition
+        static constexpr size_t INLINE_CANDIDATE_SIZE = 250;
+
+        /**
+         * @brief The requested functions and the small functions defined in the module they call
+         *
+         * The optimizer sees one partition at a time and cannot inline across partitions, so a
+         * partition of the requested function alone would leave every call a call through a stub.
+         * Callees small enough to be inlined are pulled in, and so are theirs in turn; larger ones
+         * stay lazy and get a partition of their own when they are first called.
+         */
+        static auto with_callees(llvm::orc::CompileOnDemandLayer::GlobalValueSet requested) {
+            std::vector<const llvm::Function*> pending;
+            for (const auto* value : requested) {
+                if (const auto* function = llvm::dyn_cast<llvm::Function>(value)) {
+                    pending.push_back(function);
+                }
+            }
+            while (!pending.empty()) {
+                const llvm::Function* function = pending.back();
+                pending.pop_back();
+                for (const auto& inst : llvm::instructions(function)) {
+                    const auto* call = llvm::dyn_cast<llvm::CallBase>(&inst);
+                    const llvm::Function* callee = call ? call->getCalledFunction() : nullptr;
+                    if (callee && !callee->isDeclaration()
+                        && callee->getInstructionCount() <= INLINE_CANDIDATE_SIZE
+                        && requested.insert(callee).second)
+                    {
+                        pending.push_back(callee);
+                    }
+                }
+            }
+            return llvm::orc::CompileOnDemandLayer::compileRequested(std::move(requested));
+        }
+
+      public:
+        /**
+         * @param compile_threads Background threads for lazy compilation (0: the calling thread)
+         */
+        LazyJit(const core::OptimizerOptions& options, unsigned compile_threads)
+            : m_TS_CTX(std::make_unique<llvm::LLVMContext>())
+            , m_OPTIMIZER(options) {
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+
+            auto jit = llvm::orc::LLLazyJITBuilder().setNumCompileThreads(compile_threads).create();
+            if (!jit) {
+                throw std::runtime_error("Cannot create JIT: " + llvm::toString(jit.takeError()));
+            }
+            m_JIT = std::move(*jit);
+            m_JIT->setPartitionFunction(with_callees);
+
+            m_JIT->getMainJITDylib().addGenerator(
+                llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                    m_JIT->getDataLayout().getGlobalPrefix())));
+
+            // Sees one partition at a time, just before it is compiled
+            m_JIT->getIRTransformLayer().setTransform(
+                [this](llvm::orc::ThreadSafeModule tsm, const llvm::orc::MaterializationResponsibility&)
+                    -> llvm::Expected<llvm::orc::ThreadSafeModule>
+                {
+                    tsm.withModuleDo(
+                        [this](llvm::Module& module)
+                        {
+                            std::lock_guard<std::mutex> lock(m_OPTIMIZER_MUTEX);
+                            m_OPTIMIZER.run(module);
+                        });
+                    return tsm;
+                });
+        }
+
+        ~LazyJit() {
+            // JIT'd code must go before the context it was created in
+            m_JIT.reset();
+        }
+
+        LazyJit(const LazyJit&) = delete;
+        auto operator=(const LazyJit&) -> LazyJit& = delete;
+
+        /**
+         * @brief Resolve symbols the program leaves undefined from a shared library too
+         *
+         * @return false (with the reason in @p error) if the library cannot be loaded
+         */
+        auto load_library(const std::string& path, std::string& error) -> bool {
+            auto generator = llvm::orc::DynamicLibrarySearchGenerator::Load(
+                path.c_str(), m_JIT->getDataLayout().getGlobalPrefix());
+            if (!generator) {
+                error = llvm::toString(generator.takeError());
+                return false;
+            }
+            m_JIT->getMainJITDylib().addGenerator(std::move(*generator));
+            return true;
+        }
+
+        /**
+         * @brief Generate @p program and call its `main`
+         *
+         * @return int The value `main` returned
+         * @throws CompileError if the program does not compile, std::runtime_error if it cannot be linked
+         */
+        auto run(const std::string& program,
+                 const std::string& current_directory,
+                 bool no_signed_wrap,
+                 bool report_struct_layout) -> int {
+            std::unique_ptr<llvm::Module> module;
+            {
+                Compiler compiler(current_directory, m_TS_CTX.getContext());
+                compiler.set_assume_no_signed_wrap(no_signed_wrap);
+                compiler.set_report_struct_layout(report_struct_layout);
+                compiler.generate(compiler.parse(compiler.preprocess(program)));
+                module = compiler.release_module();
+            }
+
+            module->setDataLayout(m_JIT->getDataLayout());
+            module->setTargetTriple(m_JIT->getTargetTriple().str());
+
+            if (auto err = m_JIT->addLazyIRModule(llvm::orc::ThreadSafeModule(std::move(module), m_TS_CTX))) {
+                throw std::runtime_error(llvm::toString(std::move(err)));
+            }
+
+            auto symbol = m_JIT->lookup("main");
+            if (!symbol) {
+                throw std::runtime_error(llvm::toString(symbol.takeError()));
+            }
+
+            auto* entry = reinterpret_cast<int (*)()>(static_cast<uintptr_t>(symbol->getAddress()));
+            int exit_code = entry();
+            std::fflush(stdout);
+            return exit_code;
+        }
+    };
+
+}    // namespace galluz
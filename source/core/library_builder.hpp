@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Object/ArchiveWriter.h>
+#include <llvm/Support/Error.h>
+
+#include "../logger.hpp"
+#include "module_manager.hpp"
+#include "types.hpp"
+
+namespace galluz::core {
+
+    /**
+     * @brief A module function callable from C as `<Module>_<name>`
+     */
+    struct ExportedFunction {
+        std::string symbol;
+        FunctionInfo info;
+    };
+
+    /**
+     * @brief Turns a generated program into the contents of a static or shared library
+     *
+     * Every function of the modules the program imports is exported under a C name; everything
+     * else gets hidden visibility so that the linker can drop or inline it across the boundary.
+     * The program's own top-level code (its `main`) is not part of a library.
+     */
+    class LibraryBuilder {
+      private:
+        llvm::Module& m_MODULE;
+        ModuleManager& m_MODULE_MANAGER;
+        std::vector<ExportedFunction> m_EXPORTS;
+
+        static auto c_type(const TypeInfo* type, bool is_parameter) -> std::string {
+            switch (type->kind) {
+                case TypeKind::INT:
+                    return (type->is_unsigned ? "uint" : "int")
+                        + std::to_string(type->llvm_type->getIntegerBitWidth()) + "_t";
+                case TypeKind::DOUBLE:
+                    return type->llvm_type->isFloatTy() ? "float" : "double";
+                case TypeKind::STRING:
+                    return "const char*";
+                case TypeKind::BOOL:
+                    return "bool";
+                case TypeKind::VOID:
+                    return "void";
+                case TypeKind::STRUCT:
+                    // Struct parameters are passed by pointer, struct fields are stored inline
+                    return is_parameter ? type->name + "*" : type->name;
+                case TypeKind::VECTOR:
+                case TypeKind::SOA:
+                case TypeKind::UNKNOWN:
+                    break;
+            }
+            return "";
+        }
+
+        /**
+         * @brief Append the typedef of @p type after those of the structs it contains
+         *
+         * Fields are listed in layout order with the struct's and fields' alignments spelled out,
+         * so C code sees the same offsets.
+         */
+        static auto emit_struct(const TypeInfo* type,
+                                const llvm::DataLayout& layout,
+                                std::unordered_set<const TypeInfo*>& emitted,
+                                std::string& out) -> void {
+            if (type->kind != TypeKind::STRUCT || !type->struct_info || !emitted.insert(type).second) {
+                return;
+            }
+
+            const auto& struct_info = *type->struct_info;
+            for (const auto& field : struct_info.fields) {
+                emit_struct(field.type, layout, emitted, out);
+            }
+
+            std::vector<const StructField*> by_offset;
+            for (const auto& field : struct_info.fields) {
+                by_offset.push_back(&field);
+            }
+            std::stable_sort(by_offset.begin(),
+                             by_offset.end(),
+                             [](const auto* a, const auto* b) { return a->offset < b->offset; });
+
+            out += "typedef struct " + type->name + " {\n";
+            for (const auto* field : by_offset) {
+                out += "    " + c_type(field->type, false) + " " + field->name;
+                if (field->align > 0) {
+                    out += " __attribute__((aligned(" + std::to_string(field->align) + ")))";
+                }
+                out += ";\n";
+            }
+            out += "}";
+            if (struct_info.packed) {
+                out += " __attribute__((packed))";
+            }
+            if (struct_info.align > layout.getABITypeAlign(struct_info.llvm_type).value()) {
+                out += " __attribute__((aligned(" + std::to_string(struct_info.align) + ")))";
+            }
+            out += " " + type->name + ";\n\n";
+        }
+
+        auto export_function(const std::string& module_name,
+                             const std::string& name,
+                             const FunctionInfo& info) -> bool {
+            if (info.return_type->kind == TypeKind::STRUCT) {
+                LOG_WARN("%s.%s returns a struct by value and is not exported",
+                         module_name.c_str(),
+                         name.c_str());
+                return true;
+            }
+            const auto has_no_c_type = [](const TypeInfo* type)
+            { return type->kind == TypeKind::VECTOR || type->kind == TypeKind::SOA; };
+            if (has_no_c_type(info.return_type)
+                || std::any_of(info.parameters.begin(),
+                               info.parameters.end(),
+                               [&](const VariableInfo& param) { return has_no_c_type(param.type_info); }))
+            {
+                LOG_WARN("%s.%s takes or returns a vector or soa-vec and is not exported",
+                         module_name.c_str(),
+                         name.c_str());
+                return true;
+            }
+
+            const std::string symbol = module_name + "_" + name;
+            auto* func = info.function;
+            func->setName(symbol);
+            if (func->getName() != symbol) {
+                LOG_ERROR("Cannot export %s.%s: the symbol %s is already defined",
+                          module_name.c_str(),
+                          name.c_str(),
+                          symbol.c_str());
+                return false;
+            }
+
+            // C passes bool and narrow integers extended to a full register
+            for (size_t i = 0; i < info.parameters.size(); ++i) {
+                const auto extension = info.parameters[i].type_info->extension_attribute();
+                if (extension != llvm::Attribute::None) {
+                    func->addParamAttr(static_cast<unsigned>(i), extension);
+                }
+            }
+            if (info.return_type->extension_attribute() != llvm::Attribute::None) {
+                func->addRetAttr(info.return_type->extension_attribute());
+            }
+
+            m_EXPORTS.push_back({symbol, info});
+            return true;
+        }
+
+      public:
+        LibraryBuilder(llvm::Module& module, ModuleManager& module_manager)
+            : m_MODULE(module)
+            , m_MODULE_MANAGER(module_manager) {}
+
+        /**
+         * @brief Drop `main`, name the exported functions and hide everything else
+         *
+         * @return false (after logging why) if an export name clashes
+         */
+        auto prepare() -> bool {
+            if (auto* main_func = m_MODULE.getFunction("main")) {
+                if (main_func->getInstructionCount() > 1) {
+                    LOG_WARN("Top-level code of the program is not part of the library and never runs");
+                }
+                main_func->eraseFromParent();
+            }
+
+            for (const auto& module : m_MODULE_MANAGER.get_used_modules()) {
+                for (const auto& [name, info] : module->scope->functions) {
+                    if (name.find('.') != std::string::npos || !module->exported_symbols.count(name)
+                        || !info.function || info.function->isDeclaration())
+                    {
+                        continue;
+                    }
+                    if (!export_function(module->name, name, info)) {
+                        return false;
+                    }
+                }
+            }
+
+            std::sort(m_EXPORTS.begin(),
+                      m_EXPORTS.end(),
+                      [](const auto& a, const auto& b) { return a.symbol < b.symbol; });
+
+            std::unordered_set<const llvm::Function*> exported;
+            for (const auto& function : m_EXPORTS) {
+                exported.insert(function.info.function);
+            }
+
+            for (auto& func : m_MODULE) {
+                if (!func.isDeclaration() && !func.hasLocalLinkage() && !exported.count(&func)) {
+                    func.setVisibility(llvm::GlobalValue::HiddenVisibility);
+                }
+            }
+            for (auto& global : m_MODULE.globals()) {
+                if (!global.isDeclaration() && !global.hasLocalLinkage()) {
+                    global.setVisibility(llvm::GlobalValue::HiddenVisibility);
+                }
+            }
+
+            return true;
+        }
+
+        auto get_exports() const -> const std::vector<ExportedFunction>& { return m_EXPORTS; }
+
+        /**
+         * @brief Write a C/C++ header declaring the exported functions and the structs they use
+         */
+        auto write_header(const std::string& path) const -> bool {
+            std::string guard = std::filesystem::path(path).filename().string();
+            for (auto& c : guard) {
+                c = std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::toupper(c)) : '_';
+            }
+
+            std::string out = "/* Generated by galluzlang, do not edit */\n"
+                              "#ifndef "
+                + guard + "\n#define " + guard
+                + "\n\n#include <stdbool.h>\n#include <stdint.h>\n\n"
+                  "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n";
+
+            std::unordered_set<const TypeInfo*> emitted;
+            for (const auto& function : m_EXPORTS) {
+                for (const auto& param : function.info.parameters) {
+                    emit_struct(param.type_info, m_MODULE.getDataLayout(), emitted, out);
+                }
+            }
+
+            for (const auto& function : m_EXPORTS) {
+                out += c_type(function.info.return_type, false) + " " + function.symbol + "(";
+                const auto& params = function.info.parameters;
+                for (size_t i = 0; i < params.size(); ++i) {
+                    out += (i > 0 ? ", " : "") + c_type(params[i].type_info, true) + " " + params[i].name;
+                }
+                out += params.empty() ? "void);\n" : ");\n";
+            }
+
+            out += "\n#ifdef __cplusplus\n}\n#endif\n\n#endif\n";
+
+            std::ofstream header(path);
+            if (!header) {
+                LOG_ERROR("Cannot write \"%s\"", path.c_str());
+                return false;
+            }
+            header << out;
+            return true;
+        }
+
+        /**
+         * @brief Pack one object file into a static archive with a symbol table
+         */
+        static auto write_archive(const std::string& object_file, const std::string& archive_path) -> bool {
+            auto member = llvm::NewArchiveMember::getFile(object_file, true);
+            if (!member) {
+                LOG_ERROR("Cannot read \"%s\": %s",
+                          object_file.c_str(),
+                          llvm::toString(member.takeError()).c_str());
+                return false;
+            }
+
+            std::vector<llvm::NewArchiveMember> members;
+            members.push_back(std::move(*member));
+
+            std::filesystem::remove(archive_path);
+            if (auto err = llvm::writeArchive(
+                    archive_path, members, true, llvm::object::Archive::K_GNU, true, false))
+            {
+                LOG_ERROR("Cannot write \"%s\": %s",
+                          archive_path.c_str(),
+                          llvm::toString(std::move(err)).c_str());
+                return false;
+            }
+            return true;
+        }
+    };
+
+}    // namespace galluz::core
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "../parser/GalluzGrammar.h"
+
+namespace galluz::core {
+
+    /**
+     * @brief One `defmodule` form of an imported file, parsed at most once per process
+     */
+    struct CachedModule {
+        std::string content;
+        std::once_flag parsed;
+        std::shared_ptr<const Exp> ast;
+    };
+
+    struct CachedModuleFile {
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size = 0;
+        size_t hash = 0;
+        std::unordered_map<std::string, std::shared_ptr<CachedModule>> modules;
+    };
+
+    /**
+     * @brief Process-wide cache of imported module files
+     *
+     * A file is re-read only when its mtime or size changed, and re-split into modules only when
+     * the hash of its contents changed too. Module ASTs are immutable once parsed, so every
+     * compilation in the process (including concurrent ones in server mode) shares them.
+     */
+    class ModuleCache {
+      public:
+        using Extractor = std::function<std::unordered_map<std::string, std::string>(const std::string&)>;
+
+      private:
+        std::mutex m_MUTEX;
+        std::unordered_map<std::string, std::shared_ptr<const CachedModuleFile>> m_FILES;
+
+        static auto read_file(const std::string& path) -> std::string {
+            std::ifstream file(path);
+            if (!file.is_open()) {
+                throw std::runtime_error("Cannot open module file: " + path);
+            }
+            return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        }
+
+      public:
+        static auto instance() -> ModuleCache& {
+            static ModuleCache cache;
+            return cache;
+        }
+
+        /**
+         * @brief Modules defined in @p path; @p extract splits fresh file contents into them
+         */
+        auto get_file(const std::string& path, const Extractor& extract)
+            -> std::shared_ptr<const CachedModuleFile> {
+            std::error_code err_code;
+            auto mtime = std::filesystem::last_write_time(path, err_code);
+            auto size = err_code ? 0 : std::filesystem::file_size(path, err_code);
+            if (err_code) {
+                throw std::runtime_error("Cannot open module file: " + path);
+            }
+
+            std::shared_ptr<const CachedModuleFile> cached;
+            {
+                std::lock_guard<std::mutex> lock(m_MUTEX);
+                auto it = m_FILES.find(path);
+                if (it != m_FILES.end()) {
+                    cached = it->second;
+                }
+            }
+
+            if (cached && cached->mtime == mtime && cached->size == size) {
+                return cached;
+            }
+
+            std::string content = read_file(path);
+            auto entry = std::make_shared<CachedModuleFile>();
+            entry->mtime = mtime;
+            entry->size = size;
+            entry->hash = std::hash<std::string> {}(content);
+
+            if (cached && cached->hash == entry->hash) {
+                // Touched but unchanged: keep the parsed modules
+                entry->modules = cached->modules;
+            } else {
+                for (auto& [name, module_content] : extract(content)) {
+                    auto module = std::make_shared<CachedModule>();
+                    module->content = std::move(module_content);
+                    entry->modules[name] = std::move(module);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_MUTEX);
+            m_FILES[path] = entry;
+            return entry;
+        }
+
+        static auto get_ast(CachedModule& module) -> const Exp& {
+            std::call_once(module.parsed,
+                           [&module]()
+                           {
+                               syntax::GalluzGrammar parser;
+                               module.ast = std::make_shared<const Exp>(parser.parse(module.content));
+                           });
+            return *module.ast;
+        }
+
+        auto clear() -> void {
+            std::lock_guard<std::mutex> lock(m_MUTEX);
+            m_FILES.clear();
+        }
+    };
+
+}    // namespace galluz::core
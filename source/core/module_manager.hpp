@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -9,6 +10,7 @@
 #include <vector>
 
 #include "generator_manager.hpp"
+#include "module_cache.hpp"
 #include "preprocessor.hpp"
 #include "types.hpp"
 
@@ -22,7 +24,18 @@ namespace galluz::core {
         std::unordered_set<std::string> exported_symbols;
         bool is_used = false;
         bool is_loaded = false;
-        std::string content;
+        std::shared_ptr<CachedModule> source;
+        /// Names defined by the module; outlives the block that imported it, bodies are generated later
+        std::unique_ptr<Scope> scope;
+    };
+
+    /**
+     * @brief A defn of an imported module whose body is generated on its first reference
+     */
+    struct LazyBody {
+        const Exp* definition;
+        Scope* scope;
+        GeneratorManager* generator_manager;
     };
 
     class ModuleManager {
@@ -33,6 +46,40 @@ namespace galluz::core {
         std::unordered_map<std::string, std::unordered_set<std::string>> file_dependencies;
         TypeSystem* type_system;
         std::string current_directory;
+        std::unordered_map<llvm::Function*, LazyBody> lazy_bodies;
+        std::vector<llvm::Function*> materialize_worklist;
+        bool is_materializing = false;
+
+        static auto root_scope(CompilationContext& context) -> Scope* {
+            Scope* scope = context.current_scope;
+            while (scope->parent) {
+                scope = scope->parent;
+            }
+            return scope;
+        }
+
+        /**
+         * @brief Record the body of a defn the declaration pass has a prototype for, instead of generating it
+         */
+        auto defer_body(const Exp& item, CompilationContext& context, GeneratorManager* generator_manager)
+            -> bool {
+            if (item.list.size() < 4 || item.list[0].string != "defn" || item.list[1].type != ExpType::LIST
+                || item.list[1].list.empty())
+            {
+                return false;
+            }
+
+            auto& functions = context.current_scope->functions;
+            auto it = functions.find(item.list[1].list[0].string);
+            if (it == functions.end() || !context.pending_prototypes.count(it->second.function)
+                || lazy_bodies.count(it->second.function))
+            {
+                return false;
+            }
+
+            lazy_bodies[it->second.function] = {&item, context.current_scope, generator_manager};
+            return true;
+        }
 
         auto find_matching_parenthesis(const std::string& str, size_t start) -> size_t {
             int depth = 0;
@@ -175,30 +222,25 @@ namespace galluz::core {
                 return existing_modules;
             }
 
-            std::ifstream file(resolved_path);
-            if (!file.is_open()) {
-                throw std::runtime_error("Cannot open module file: " + resolved_path);
-            }
-
-            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-            file.close();
+            auto cached_file = ModuleCache::instance().get_file(
+                resolved_path,
+                [this](const std::string& content)
+                {
+                    Preprocessor preprocessor;
+                    return extract_module_definitions(preprocessor.preprocess(content));
+                });
 
             loaded_files.insert(resolved_path);
             file_dependencies[resolved_path] = {};
 
-            Preprocessor preprocessor;
-            std::string processed = preprocessor.preprocess(content);
-
-            auto module_definitions = extract_module_definitions(processed);
-
             std::unordered_map<std::string, std::shared_ptr<ModuleInfo>> loaded_modules;
 
-            for (const auto& [module_name, module_content] : module_definitions) {
+            for (const auto& [module_name, cached_module] : cached_file->modules) {
                 auto module_info = std::make_shared<ModuleInfo>();
                 module_info->name = module_name;
                 module_info->file_path = resolved_path;
                 module_info->is_loaded = true;
-                module_info->content = module_content;
+                module_info->source = cached_module;
 
                 modules[module_name] = module_info;
                 loaded_modules[module_name] = module_info;
@@ -254,12 +296,19 @@ namespace galluz::core {
 
             module->is_used = true;
 
-            std::unique_ptr<syntax::GalluzGrammar> parser = std::make_unique<syntax::GalluzGrammar>();
-            Exp module_ast = parser->parse(module->content);
+            const Exp& module_ast = ModuleCache::get_ast(*module->source);
+
+            // Module bodies are generated on demand, possibly after the importing block is gone, so
+            // they only see the module itself and the program's outermost scope
+            auto* importing_scope = context.current_scope;
+            module->scope = std::make_unique<Scope>(root_scope(context));
+            context.current_scope = module->scope.get();
 
             if (module_ast.type == ExpType::LIST && module_ast.list.size() >= 2) {
                 const auto& name_exp = module_ast.list[1];
                 if (name_exp.type == ExpType::SYMBOL && name_exp.string == module_name) {
+                    generator_manager->declare_forms(module_ast.list, 2, context);
+
                     for (size_t i = 2; i < module_ast.list.size(); ++i) {
                         const auto& item = module_ast.list[i];
                         if (item.type == ExpType::LIST && !item.list.empty()) {
@@ -290,11 +339,18 @@ namespace galluz::core {
                                 }
                             }
                         }
-                        generator_manager->generate_code(item, context);
+                        if (!defer_body(item, context, generator_manager)) {
+                            generator_manager->generate_code(item, context);
+                        }
                     }
                 }
             }
 
+            context.current_scope = importing_scope;
+            for (const auto& [name, func_info] : module->scope->functions) {
+                importing_scope->functions[name] = func_info;
+            }
+
             for (const auto& symbol : module->exported_symbols) {
                 if (symbol_to_module.count(symbol)) {
                     throw std::runtime_error("Symbol conflict: " + symbol + " already exported from module "
@@ -304,6 +360,74 @@ namespace galluz::core {
             }
         }
 
+        /**
+         * @brief Generate the body of @p func if it is a deferred module function, and of everything it uses
+         *
+         * Called on every reference to a function. Bodies referenced while one is being generated are
+         * queued and generated afterwards, until no new references appear.
+         */
+        auto materialize(llvm::Function* func, CompilationContext& context) -> void {
+            if (!lazy_bodies.count(func)) {
+                return;
+            }
+
+            materialize_worklist.push_back(func);
+            if (is_materializing) {
+                return;
+            }
+
+            // The body is generated in the middle of its first caller, but has none of its state
+            is_materializing = true;
+            auto* saved_scope = context.current_scope;
+            auto caller = context.enter_function(nullptr);
+            try {
+                while (!materialize_worklist.empty()) {
+                    auto it = lazy_bodies.find(materialize_worklist.back());
+                    materialize_worklist.pop_back();
+                    if (it == lazy_bodies.end()) {
+                        continue;
+                    }
+
+                    LazyBody body = it->second;
+                    lazy_bodies.erase(it);
+
+                    context.current_scope = body.scope;
+                    body.generator_manager->generate_code(*body.definition, context);
+                }
+            } catch (...) {
+                materialize_worklist.clear();
+                context.current_scope = saved_scope;
+                context.leave_function(caller);
+                is_materializing = false;
+                throw;
+            }
+            context.current_scope = saved_scope;
+            context.leave_function(caller);
+            is_materializing = false;
+        }
+
+        /**
+         * @brief Generate every deferred body, e.g. because a library exports all module functions
+         */
+        auto materialize_all(CompilationContext& context) -> void {
+            while (!lazy_bodies.empty()) {
+                materialize(lazy_bodies.begin()->first, context);
+            }
+        }
+
+        /**
+         * @brief Erase the prototypes of module functions that were never referenced
+         */
+        auto discard_unused_functions(CompilationContext& context) -> void {
+            for (auto& [func, body] : lazy_bodies) {
+                if (func->use_empty()) {
+                    context.pending_prototypes.erase(func);
+                    func->eraseFromParent();
+                }
+            }
+            lazy_bodies.clear();
+        }
+
         auto use_module(const std::string& module_name, CompilationContext& context) -> void {
             auto module_it = modules.find(module_name);
             if (module_it == modules.end() || !module_it->second->is_loaded) {
@@ -357,6 +481,35 @@ namespace galluz::core {
             return nullptr;
         }
 
+        /**
+         * @brief Modules registered in this compilation, in name order
+         */
+        auto get_used_modules() const -> std::vector<std::shared_ptr<ModuleInfo>> {
+            std::vector<std::shared_ptr<ModuleInfo>> used;
+            for (const auto& [name, info] : modules) {
+                if (info->is_used) {
+                    used.push_back(info);
+                }
+            }
+            std::sort(used.begin(),
+                      used.end(),
+                      [](const auto& a, const auto& b) { return a->name < b->name; });
+            return used;
+        }
+
+        /**
+         * @brief Names of all functions exported by the modules registered in this compilation
+         */
+        auto get_exported_symbols() const -> std::unordered_set<std::string> {
+            std::unordered_set<std::string> exported;
+            for (const auto& [name, info] : modules) {
+                if (info->is_used) {
+                    exported.insert(info->exported_symbols.begin(), info->exported_symbols.end());
+                }
+            }
+            return exported;
+        }
+
         auto has_module(const std::string& name) -> bool {
             auto it = modules.find(name);
             return it != modules.end() && it->second->is_loaded;
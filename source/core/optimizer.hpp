@@ -0,0 +1,234 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <llvm/ADT/Optional.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/IR/DiagnosticHandler.h>
+#include <llvm/IR/DiagnosticInfo.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Module.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/PGOOptions.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/IPO/HotColdSplitting.h>
+
+#include "../logger.hpp"
+
+namespace galluz::core {
+
+    enum class ProfileMode { NONE, GENERATE, USE };
+
+    struct OptimizerOptions {
+        llvm::OptimizationLevel level = llvm::OptimizationLevel::O3;
+        ProfileMode profile_mode = ProfileMode::NONE;
+        /// GENERATE: raw profile path written by the instrumented binary (may contain %p, %m)
+        /// USE: merged .profdata produced by llvm-profdata
+        std::string profile_file;
+        /// Also report why loops were or were not vectorized, unrolled or distributed
+        bool loop_remarks = false;
+    };
+
+    /**
+     * @brief Reports what the loop passes did with the hints of `for` and `while` loops
+     *
+     * A hint that could not be honored (a transformation-failure diagnostic) is always a warning.
+     * With verbose set, the passed, missed and analysis remarks of the loop passes are logged
+     * too, which is where the reason a loop was not vectorized is given.
+     */
+    class LoopRemarkHandler : public llvm::DiagnosticHandler {
+      private:
+        bool m_VERBOSE;
+
+        static auto is_loop_pass(llvm::StringRef pass_name) -> bool {
+            static const llvm::StringSet<> loop_passes = {
+                "loop-vectorize", "loop-unroll", "loop-distribute", "transform-warning"};
+            return loop_passes.contains(pass_name);
+        }
+
+      public:
+        explicit LoopRemarkHandler(bool verbose)
+            : m_VERBOSE(verbose) {}
+
+        auto isAnyRemarkEnabled() const -> bool override { return m_VERBOSE; }
+        auto isAnalysisRemarkEnabled(llvm::StringRef pass_name) const -> bool override {
+            return m_VERBOSE && is_loop_pass(pass_name);
+        }
+        auto isMissedOptRemarkEnabled(llvm::StringRef pass_name) const -> bool override {
+            return m_VERBOSE && is_loop_pass(pass_name);
+        }
+        auto isPassedOptRemarkEnabled(llvm::StringRef pass_name) const -> bool override {
+            return m_VERBOSE && is_loop_pass(pass_name);
+        }
+
+        auto handleDiagnostics(const llvm::DiagnosticInfo& info) -> bool override {
+            const auto* remark = llvm::dyn_cast<llvm::DiagnosticInfoOptimizationBase>(&info);
+            if (!remark) {
+                return false;
+            }
+            // The context hands every remark to the handler; drop those of other passes here
+            if (!remark->isEnabled()) {
+                return true;
+            }
+
+            const std::string function = remark->getFunction().getName().str();
+            const std::string message = remark->getMsg();
+            if (info.getKind() == llvm::DK_OptimizationFailure) {
+                LOG_WARN("%s: %s", function.c_str(), message.c_str());
+            } else if (m_VERBOSE) {
+                LOG_NOTE("%s: %s", function.c_str(), message.c_str());
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief In-process LLVM optimization pipeline
+     *
+     * Runs the PassBuilder default pipeline for the host target. With a profile mode set, the same
+     * pipeline instruments every function and CFG edge (GENERATE) or annotates branch weights and
+     * function entry counts from a merged profile, then splits cold code out of hot functions (USE).
+     */
+    class Optimizer {
+      private:
+        OptimizerOptions m_OPTIONS;
+        std::unique_ptr<llvm::TargetMachine> m_TARGET_MACHINE;
+
+      public:
+        static auto create_host_target_machine() -> std::unique_ptr<llvm::TargetMachine> {
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+
+            const std::string triple = llvm::sys::getDefaultTargetTriple();
+
+            std::string error;
+            const auto* target = llvm::TargetRegistry::lookupTarget(triple, error);
+            if (target == nullptr) {
+                LOG_WARN("No LLVM target for \"%s\" (%s), optimizing without target information",
+                         triple.c_str(),
+                         error.c_str());
+                return nullptr;
+            }
+
+            // Generic CPU: the produced binary must run wherever the C toolchain's output would
+            return std::unique_ptr<llvm::TargetMachine>(target->createTargetMachine(
+                triple, "generic", "", llvm::TargetOptions(), llvm::Reloc::PIC_));
+        }
+
+        /**
+         * @brief Data layout of the host, which code generation needs before optimization sets it
+         */
+        static auto host_data_layout() -> const std::string& {
+            static const std::string layout = []
+            {
+                auto machine = create_host_target_machine();
+                return machine ? machine->createDataLayout().getStringRepresentation() : std::string();
+            }();
+            return layout;
+        }
+
+      private:
+        auto make_pgo_options() const -> llvm::Optional<llvm::PGOOptions> {
+            switch (m_OPTIONS.profile_mode) {
+                case ProfileMode::GENERATE:
+                    return llvm::PGOOptions(m_OPTIONS.profile_file, "", "", llvm::PGOOptions::IRInstr);
+                case ProfileMode::USE:
+                    return llvm::PGOOptions(m_OPTIONS.profile_file, "", "", llvm::PGOOptions::IRUse);
+                case ProfileMode::NONE:
+                    break;
+            }
+            return llvm::None;
+        }
+
+      public:
+        explicit Optimizer(OptimizerOptions options = {})
+            : m_OPTIONS(std::move(options))
+            , m_TARGET_MACHINE(create_host_target_machine()) {}
+
+        auto get_target_machine() const -> llvm::TargetMachine* { return m_TARGET_MACHINE.get(); }
+
+        /// Lets one optimizer (and its target machine) serve several instrumented outputs
+        auto set_profile_file(std::string profile_file) -> void {
+            m_OPTIONS.profile_file = std::move(profile_file);
+        }
+
+        auto run(llvm::Module& module) -> void {
+            if (m_TARGET_MACHINE) {
+                module.setTargetTriple(m_TARGET_MACHINE->getTargetTriple().str());
+                module.setDataLayout(m_TARGET_MACHINE->createDataLayout());
+            }
+
+            llvm::LoopAnalysisManager loop_am;
+            llvm::FunctionAnalysisManager function_am;
+            llvm::CGSCCAnalysisManager cgscc_am;
+            llvm::ModuleAnalysisManager module_am;
+
+            llvm::PassBuilder pass_builder(
+                m_TARGET_MACHINE.get(), llvm::PipelineTuningOptions(), make_pgo_options());
+
+            if (m_OPTIONS.profile_mode == ProfileMode::USE) {
+                pass_builder.registerOptimizerLastEPCallback(
+                    [](llvm::ModulePassManager& module_pm, llvm::OptimizationLevel)
+                    { module_pm.addPass(llvm::HotColdSplittingPass()); });
+            }
+
+            pass_builder.registerModuleAnalyses(module_am);
+            pass_builder.registerCGSCCAnalyses(cgscc_am);
+            pass_builder.registerFunctionAnalyses(function_am);
+            pass_builder.registerLoopAnalyses(loop_am);
+            pass_builder.crossRegisterProxies(loop_am, function_am, cgscc_am, module_am);
+
+            auto& llvm_context = module.getContext();
+            auto previous_handler = llvm_context.getDiagnosticHandler();
+            llvm_context.setDiagnosticHandler(std::make_unique<LoopRemarkHandler>(m_OPTIONS.loop_remarks));
+
+            auto module_pm = m_OPTIONS.level == llvm::OptimizationLevel::O0
+                ? pass_builder.buildO0DefaultPipeline(m_OPTIONS.level)
+                : pass_builder.buildPerModuleDefaultPipeline(m_OPTIONS.level);
+            module_pm.run(module, module_am);
+
+            llvm_context.setDiagnosticHandler(std::move(previous_handler));
+        }
+
+        /**
+         * @brief Write machine code for an already optimized module
+         *
+         * @return false (after logging why) if there is no target machine or the file cannot be written
+         */
+        auto emit_object(llvm::Module& module,
+                         const std::string& path,
+                         llvm::CodeGenFileType file_type = llvm::CGFT_ObjectFile) -> bool {
+            if (!m_TARGET_MACHINE) {
+                LOG_ERROR("Cannot emit \"%s\" without a target machine", path.c_str());
+                return false;
+            }
+
+            std::error_code err_code;
+            llvm::raw_fd_ostream out_file(path, err_code, llvm::sys::fs::OF_None);
+            if (err_code) {
+                LOG_ERROR("Cannot write \"%s\": %s", path.c_str(), err_code.message().c_str());
+                return false;
+            }
+
+            llvm::legacy::PassManager codegen_pm;
+            if (m_TARGET_MACHINE->addPassesToEmitFile(codegen_pm, out_file, nullptr, file_type)) {
+                LOG_ERROR("Target cannot emit files of this type");
+                return false;
+            }
+            codegen_pm.run(module);
+            out_file.flush();
+
+            return true;
+        }
+    };
+
+}    // namespace galluz::core
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+
+#include "../logger.hpp"
+#include "optimizer.hpp"
+
+namespace galluz::core {
+
+    /**
+     * @brief Optimizes and compiles one module as independent partitions on several threads
+     *
+     * The module is cut by function with SplitModule. Internal functions (everything
+     * AttributeInference did not leave exported) are kept in the partition of the functions that
+     * use them, so they can still be inlined there; only external functions are spread across
+     * partitions. Every partition is round-tripped through bitcode into its own LLVMContext, which
+     * is what lets the threads run the optimizer and code generator concurrently.
+     */
+    class ParallelBackend {
+      private:
+        OptimizerOptions m_OPTIONS;
+        size_t m_THREAD_COUNT;
+
+        static auto split(llvm::Module& module, size_t partition_count) -> std::vector<llvm::SmallString<0>> {
+            std::vector<llvm::SmallString<0>> partitions;
+            llvm::SplitModule(module,
+                              static_cast<unsigned>(partition_count),
+                              [&partitions](std::unique_ptr<llvm::Module> partition)
+                              {
+                                  llvm::SmallString<0> bitcode;
+                                  llvm::raw_svector_ostream out(bitcode);
+                                  llvm::WriteBitcodeToFile(*partition, out);
+                                  partitions.push_back(std::move(bitcode));
+                              },
+                              /*PreserveLocals=*/true);
+            return partitions;
+        }
+
+        auto compile_partition(const llvm::SmallString<0>& bitcode,
+                               const std::string& object_file,
+                               Optimizer& optimizer) -> void {
+            llvm::LLVMContext context;
+            auto partition = llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), object_file), context);
+            if (!partition) {
+                throw std::runtime_error("Cannot load partition " + object_file + ": "
+                                         + llvm::toString(partition.takeError()));
+            }
+
+            optimizer.run(**partition);
+            if (!optimizer.emit_object(**partition, object_file)) {
+                throw std::runtime_error("Cannot emit " + object_file);
+            }
+        }
+
+      public:
+        ParallelBackend(OptimizerOptions options, size_t thread_count)
+            : m_OPTIONS(std::move(options))
+            , m_THREAD_COUNT(std::max<size_t>(1, thread_count)) {}
+
+        /**
+         * @brief Compile @p module to `<output_base>.part<N>.o` files
+         *
+         * @return std::vector<std::string> Paths of the objects to link
+         * @throws std::runtime_error if any partition fails
+         */
+        auto run(llvm::Module& module, const std::string& output_base) -> std::vector<std::string> {
+            // Target registration is not thread-safe; afterwards the workers only read the registry
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+
+            auto partitions = split(module, m_THREAD_COUNT);
+
+            std::vector<std::string> object_files;
+            for (size_t i = 0; i < partitions.size(); ++i) {
+                object_files.push_back(output_base + ".part" + std::to_string(i) + ".o");
+            }
+
+            std::atomic<size_t> next_partition {0};
+            std::mutex error_mutex;
+            std::string first_error;
+
+            auto worker = [&]()
+            {
+                Optimizer optimizer(m_OPTIONS);
+                for (size_t i = next_partition++; i < partitions.size(); i = next_partition++) {
+                    try {
+                        compile_partition(partitions[i], object_files[i], optimizer);
+                    } catch (const std::exception& e) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (first_error.empty()) {
+                            first_error = e.what();
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < std::min(m_THREAD_COUNT, partitions.size()); ++i) {
+                workers.emplace_back(worker);
+            }
+            worker();
+            for (auto& thread : workers) {
+                thread.join();
+            }
+
+            if (!first_error.empty()) {
+                throw std::runtime_error(first_error);
+            }
+
+            return object_files;
+        }
+    };
+
+}    // namespace galluz::core
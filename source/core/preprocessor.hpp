@@ -137,11 +137,13 @@ namespace galluz::core {
         }
 
       public:
-        auto preprocess(const std::string& code) -> std::string {
+        /**
+         * @brief Strip comments and split the code into its top-level expressions
+         */
+        auto split_expressions(const std::string& code) -> std::vector<std::string> {
             std::stringstream ss(code);
             std::string line;
             std::string processed_code;
-            std::string full_program;
             int line_num = 0;
 
             while (std::getline(ss, line)) {
@@ -206,6 +208,13 @@ namespace galluz::core {
                 }
             }
 
+            return expressions;
+        }
+
+        auto preprocess(const std::string& code) -> std::string {
+            std::vector<std::string> expressions = split_expressions(code);
+            std::string full_program;
+
             if (expressions.empty()) {
                 throw std::runtime_error("No expressions found in program");
             }
@@ -0,0 +1,446 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <readline/history.h>
+#include <readline/readline.h>
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include "../logger.hpp"
+#include "compiler.hpp"
+
+namespace galluz {
+
+    /**
+     * @brief Interactive session on top of one persistent Compiler and an LLJIT
+     *
+     * The compiler's module acts as a declaration table. Every top-level form is generated into it
+     * inside a fresh `__repl_N` function; the new definitions are then cloned into a module of
+     * their own, added to the JIT under a resource tracker, and stripped back to declarations in
+     * the persistent module. Functions, globals and structs of earlier lines therefore stay visible
+     * to the compiler and resolve to the JIT'd code of the line that defined them.
+     *
+     * Top-level `var`s (and struct instances) cannot live on the stack of `__repl_N`, so their
+     * slots are promoted to globals before the line is handed to the JIT.
+     */
+    class Repl {
+      private:
+        llvm::orc::ThreadSafeContext m_TS_CTX;
+        std::unique_ptr<Compiler> m_COMPILER;
+        std::unique_ptr<llvm::orc::LLJIT> m_JIT;
+        size_t m_LINE_COUNTER = 0;
+        bool m_PRINT_IR = false;
+
+        static auto is_statement(const Exp& ast) -> bool {
+            static const std::unordered_set<std::string> STATEMENTS = {"defn",
+                                                                       "struct",
+                                                                       "var",
+                                                                       "global",
+                                                                       "import",
+                                                                       "defmodule",
+                                                                       "moduleuse",
+                                                                       "extern",
+                                                                       "fprint",
+                                                                       "while",
+                                                                       "for",
+                                                                       "cond",
+                                                                       "match"};
+            return ast.type == ExpType::LIST && !ast.list.empty() && ast.list[0].type == ExpType::SYMBOL
+                && STATEMENTS.count(ast.list[0].string);
+        }
+
+        static auto is_balanced(const std::string& text) -> bool {
+            int depth = 0;
+            bool in_string = false;
+            bool escaped = false;
+            for (char c : text) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = true;
+                } else if (c == '"') {
+                    in_string = !in_string;
+                } else if (!in_string && c == '(') {
+                    depth++;
+                } else if (!in_string && c == ')') {
+                    depth--;
+                }
+            }
+            return depth <= 0 && !in_string;
+        }
+
+        /**
+         * @brief Print the value of an expression line from inside the JIT'd wrapper
+         *
+         * Integers are printed with their width and signedness: 64-bit ones as such, narrower ones
+         * extended to 32 bits the way C promotes them. f32 is widened to double.
+         */
+        auto emit_print_result(llvm::Value* value, bool is_unsigned) -> void {
+            auto& context = m_COMPILER->get_compilation_context();
+            auto& builder = context.m_BUILDER;
+            llvm::Type* type = value->getType();
+
+            const char* format = nullptr;
+            if (type->isIntegerTy(1)) {
+                value = builder.CreateZExt(value, builder.getInt32Ty());
+                format = "=> %d\n";
+            } else if (type->isIntegerTy(64)) {
+                format = is_unsigned ? "=> %llu\n" : "=> %lld\n";
+            } else if (type->isIntegerTy() && type->getIntegerBitWidth() <= 32) {
+                value = builder.CreateIntCast(value, builder.getInt32Ty(), !is_unsigned);
+                format = is_unsigned ? "=> %u\n" : "=> %d\n";
+            } else if (type->isFloatTy()) {
+                value = builder.CreateFPExt(value, builder.getDoubleTy());
+                format = "=> %f\n";
+            } else if (type->isDoubleTy()) {
+                format = "=> %f\n";
+            } else if (type == builder.getInt8Ty()->getPointerTo()) {
+                format = "=> %s\n";
+            } else {
+                return;
+            }
+
+            auto* printf_func = context.m_MODULE.getFunction("printf");
+            builder.CreateCall(printf_func, {builder.CreateGlobalStringPtr(format), value});
+        }
+
+        /**
+         * @brief Move stack slots that must outlive `__repl_N` into globals
+         *
+         * Slots of variables declared at the top-level scope keep their name, so SymbolGenerator
+         * finds them on later lines; struct instances they point to get a private unique name.
+         */
+        auto promote_line_slots(llvm::Function* wrapper) -> void {
+            auto& context = m_COMPILER->get_compilation_context();
+            auto& module = context.m_MODULE;
+            auto* top_scope = context.get_current_scope();
+
+            for (auto& [name, var_info] : top_scope->variables) {
+                auto* slot = llvm::dyn_cast<llvm::AllocaInst>(var_info.value);
+                if (!slot || slot->getFunction() != wrapper) {
+                    continue;
+                }
+
+                llvm::Type* slot_type = slot->getAllocatedType();
+                auto* global = module.getNamedGlobal(name);
+                if (global && global->getValueType() != slot_type) {
+                    throw std::runtime_error("Variable " + name + " was already defined with another type");
+                }
+                if (!global) {
+                    global = new llvm::GlobalVariable(module,
+                                                      slot_type,
+                                                      false,
+                                                      llvm::GlobalValue::ExternalLinkage,
+                                                      llvm::Constant::getNullValue(slot_type),
+                                                      name);
+                }
+
+                slot->replaceAllUsesWith(global);
+                slot->eraseFromParent();
+
+                var_info.value = global;
+                var_info.is_global = true;
+            }
+
+            std::vector<llvm::AllocaInst*> struct_slots;
+            for (auto& inst : wrapper->getEntryBlock()) {
+                auto* slot = llvm::dyn_cast<llvm::AllocaInst>(&inst);
+                if (slot && slot->getAllocatedType()->isStructTy()) {
+                    struct_slots.push_back(slot);
+                }
+            }
+
+            for (auto* slot : struct_slots) {
+                llvm::Type* slot_type = slot->getAllocatedType();
+                auto* global = new llvm::GlobalVariable(module,
+                                                        slot_type,
+                                                        false,
+                                                        llvm::GlobalValue::ExternalLinkage,
+                                                        llvm::Constant::getNullValue(slot_type),
+                                                        wrapper->getName() + "." + slot->getName());
+                slot->replaceAllUsesWith(global);
+                slot->eraseFromParent();
+            }
+        }
+
+        /**
+         * @brief Give every new definition an external name so later lines can link against it
+         */
+        static auto collect_new_definitions(llvm::Module& module,
+                                            std::vector<llvm::Function*>& functions,
+                                            std::vector<llvm::GlobalVariable*>& globals,
+                                            const std::string& prefix) -> void {
+            size_t anonymous = 0;
+            for (auto& global : module.globals()) {
+                if (global.isDeclaration()) {
+                    continue;
+                }
+                if (!global.hasName()) {
+                    global.setName(prefix + ".g" + std::to_string(anonymous++));
+                }
+                global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                globals.push_back(&global);
+            }
+
+            for (auto& func : module) {
+                if (func.isDeclaration()) {
+                    continue;
+                }
+                func.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                functions.push_back(&func);
+            }
+        }
+
+        /**
+         * @brief Remove the wrapper and every defn or prototype a failed line left in the module
+         */
+        static auto discard_new_functions(llvm::Module& module,
+                                          core::CompilationContext& context,
+                                          const std::unordered_set<const llvm::Function*>& known_functions)
+            -> void {
+            std::vector<llvm::Function*> new_functions;
+            for (auto& func : module) {
+                if (!known_functions.count(&func)) {
+                    new_functions.push_back(&func);
+                }
+            }
+
+            auto& functions = context.get_current_scope()->functions;
+            for (auto it = functions.begin(); it != functions.end();) {
+                bool is_new = !known_functions.count(it->second.function);
+                it = is_new ? functions.erase(it) : std::next(it);
+            }
+
+            for (auto* func : new_functions) {
+                func->dropAllReferences();
+                context.pending_prototypes.erase(func);
+            }
+            for (auto* func : new_functions) {
+                func->eraseFromParent();
+            }
+        }
+
+        auto evaluate_form(const std::string& source) -> void {
+            auto& context = m_COMPILER->get_compilation_context();
+            auto& module = context.m_MODULE;
+            auto& builder = context.m_BUILDER;
+
+            Exp ast = m_COMPILER->parse(source);
+
+            const size_t scope_depth = context.scopes.size();
+            auto* line_scope = context.current_scope;
+            std::unordered_set<const llvm::Function*> known_functions;
+            std::vector<llvm::Function*> known_declarations;
+            for (auto& func : module) {
+                known_functions.insert(&func);
+                if (func.isDeclaration()) {
+                    known_declarations.push_back(&func);
+                }
+            }
+
+            const std::string wrapper_name = "__repl_" + std::to_string(++m_LINE_COUNTER);
+            auto* wrapper = llvm::Function::Create(llvm::FunctionType::get(builder.getInt32Ty(), false),
+                                                   llvm::Function::ExternalLinkage,
+                                                   wrapper_name,
+                                                   module);
+            builder.SetInsertPoint(llvm::BasicBlock::Create(context.m_CTX, "entry", wrapper));
+            context.m_CURRENT_FUNCTION = wrapper;
+
+            try {
+                llvm::Value* result = m_COMPILER->get_generator_manager().generate_code(ast, context);
+
+                if (!builder.GetInsertBlock()->getTerminator()) {
+                    if (result && !is_statement(ast)) {
+                        emit_print_result(result, context.is_unsigned(ast));
+                    }
+                    builder.CreateRet(builder.getInt32(0));
+                }
+
+                promote_line_slots(wrapper);
+
+                if (llvm::verifyModule(module, &llvm::errs())) {
+                    throw std::runtime_error("Generated code is invalid");
+                }
+            } catch (...) {
+                // A defn that failed half-way leaves its scopes pushed and its tail-call state set
+                while (context.scopes.size() > scope_depth) {
+                    context.pop_scope();
+                }
+                context.current_scope = line_scope;
+                context.tail_positions.clear();
+                context.tail_recurse_block = nullptr;
+                context.param_slots.clear();
+
+                auto& variables = context.get_current_scope()->variables;
+                for (auto it = variables.begin(); it != variables.end();) {
+                    auto* inst = llvm::dyn_cast<llvm::Instruction>(it->second.value);
+                    it = inst && inst->getFunction() == wrapper ? variables.erase(it) : std::next(it);
+                }
+                discard_new_functions(module, context, known_functions);
+                // A module function whose body failed to generate on its first call; bodies that did
+                // generate stay and are handed to the JIT with the next line
+                for (auto* func : known_declarations) {
+                    if (!func->isDeclaration() && llvm::verifyFunction(*func)) {
+                        func->deleteBody();
+                    }
+                }
+                throw;
+            }
+
+            std::vector<llvm::Function*> new_functions;
+            std::vector<llvm::GlobalVariable*> new_globals;
+            collect_new_definitions(module, new_functions, new_globals, wrapper_name);
+
+            auto line_module = llvm::CloneModule(module);
+            line_module->setModuleIdentifier(wrapper_name);
+
+            if (m_PRINT_IR) {
+                line_module->print(llvm::outs(), nullptr);
+            }
+
+            // The persistent module only keeps declarations of what the JIT now owns
+            for (auto* func : new_functions) {
+                func->deleteBody();
+            }
+            for (auto* global : new_globals) {
+                global->setInitializer(nullptr);
+            }
+
+            auto tracker = m_JIT->getMainJITDylib().createResourceTracker();
+            llvm::orc::ThreadSafeModule line_tsm(std::move(line_module), m_TS_CTX);
+            if (auto err = m_JIT->addIRModule(tracker, std::move(line_tsm))) {
+                throw std::runtime_error(llvm::toString(std::move(err)));
+            }
+
+            auto symbol = m_JIT->lookup(wrapper_name);
+            if (!symbol) {
+                llvm::cantFail(tracker->remove());
+                throw std::runtime_error(llvm::toString(symbol.takeError()));
+            }
+
+            auto* entry = reinterpret_cast<int (*)()>(static_cast<uintptr_t>(symbol->getAddress()));
+            entry();
+            std::fflush(stdout);
+        }
+
+        auto handle_command(const std::string& command) -> bool {
+            if (command == ":quit" || command == ":q") {
+                return false;
+            }
+            if (command == ":ir") {
+                m_PRINT_IR = !m_PRINT_IR;
+                LOG_INFO("IR printing %s", m_PRINT_IR ? "enabled" : "disabled");
+            } else if (command == ":help") {
+                std::cout << ":ir    toggle printing the IR of each evaluated form\n"
+                             ":quit  leave the session\n";
+            } else {
+                LOG_ERROR("Unknown command: %s", command.c_str());
+            }
+            return true;
+        }
+
+      public:
+        explicit Repl(const std::string& current_directory)
+            : m_TS_CTX(std::make_unique<llvm::LLVMContext>()) {
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+
+            auto jit = llvm::orc::LLJITBuilder().create();
+            if (!jit) {
+                throw std::runtime_error("Cannot create JIT: " + llvm::toString(jit.takeError()));
+            }
+            m_JIT = std::move(*jit);
+
+            m_JIT->getMainJITDylib().addGenerator(
+                llvm::cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+                    m_JIT->getDataLayout().getGlobalPrefix())));
+
+            m_COMPILER = std::make_unique<Compiler>(current_directory, m_TS_CTX.getContext());
+
+            auto& module = m_COMPILER->get_module();
+            module.setDataLayout(m_JIT->getDataLayout());
+            module.setTargetTriple(m_JIT->getTargetTriple().str());
+        }
+
+        ~Repl() {
+            // JIT'd code and the compiler's module must go before the context they were created in
+            m_JIT.reset();
+            m_COMPILER.reset();
+        }
+
+        Repl(const Repl&) = delete;
+        auto operator=(const Repl&) -> Repl& = delete;
+
+        auto evaluate(const std::string& input) -> void {
+            core::Preprocessor preprocessor;
+            for (const auto& form : preprocessor.split_expressions(input)) {
+                evaluate_form(form);
+            }
+        }
+
+        auto run() -> int {
+            std::cout << "galluz REPL, :help for commands, :quit to leave\n";
+
+            std::string pending;
+            while (true) {
+                char* raw_line = readline(pending.empty() ? "galluz> " : "   ...> ");
+                if (!raw_line) {
+                    std::cout << "\n";
+                    break;
+                }
+
+                std::string line(raw_line);
+                std::free(raw_line);
+
+                if (pending.empty() && !line.empty() && line[0] == ':') {
+                    add_history(line.c_str());
+                    if (!handle_command(line)) {
+                        break;
+                    }
+                    continue;
+                }
+
+                pending += line + "\n";
+                if (!is_balanced(pending)) {
+                    continue;
+                }
+
+                std::string input = std::move(pending);
+                pending.clear();
+
+                if (input.find_first_not_of(" \t\n") == std::string::npos) {
+                    continue;
+                }
+                add_history(input.c_str());
+
+                Logger::clear_expressions();
+                try {
+                    evaluate(input);
+                } catch (const CompileError&) {
+                    // Already reported with its expression traceback; the session goes on
+                } catch (const std::exception& e) {
+                    LOG_ERROR("%s", e.what());
+                }
+            }
+
+            return 0;
+        }
+    };
+
+}    // namespace galluz
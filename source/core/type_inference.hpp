@@ -0,0 +1,391 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "types.hpp"
+
+namespace galluz::core {
+
+    /**
+     * @brief Static types of expressions, worked out from the AST before any code is generated
+     *
+     * Gives a `!auto` function its return type before its prototype exists, so that callers,
+     * forward references and recursion see a concrete signature. The rules are the ones the
+     * generators apply to values:
+     *
+     *  - unsuffixed literals are int (i64 if they do not fit) and double, suffixed ones their type;
+     *  - arithmetic has the common type of its operands, so integer code stays integer;
+     *  - comparisons and logical connectives are int, casts their target type;
+     *  - `if`, `cond` and `match` have the common type of their branches, which must all be
+     *    numbers if they are not all of one type.
+     *
+     * A call to the function being typed has no type of its own yet and takes the one the other
+     * branches give it, so a recursive function is typed by its base cases.
+     */
+    class TypeInference {
+      private:
+        CompilationContext& m_CONTEXT;
+        TypeSystem& m_TYPES;
+        /// Variables declared in the body, innermost scope last
+        std::vector<std::unordered_map<std::string, TypeInfo*>> m_SCOPES;
+        /// The function being typed: calls to it are recursive
+        std::string m_FUNCTION;
+        /// The body refers to a variable or function that is not known (yet)
+        bool m_UNRESOLVED = false;
+        /// Why the body has no type, if its branches disagree
+        std::string m_CONFLICT;
+
+        inline static const std::unordered_set<std::string> ARITHMETIC = {
+            "+", "-", "*", "/", "%", "min", "max", "abs", "popcount", "clz", "ctz", "bswap", "rotl", "rotr"};
+        inline static const std::unordered_set<std::string> FLOATING_POINT = {
+            "sqrt", "floor", "ceil", "exp", "log", "pow", "copysign", "fma"};
+        inline static const std::unordered_set<std::string> COMPARISONS = {"<", ">", "<=", "==", "!=", ">="};
+        inline static const std::unordered_set<std::string> INT_VALUED = {
+            "and", "or", "not", "hasprop", "fprint", "while", "for", "break", "continue", "soa-free"};
+        inline static const std::unordered_set<std::string> LANE_VALUED = {
+            "extract", "reduce-add", "reduce-min", "reduce-max"};
+
+        /**
+         * @brief The Galluz type of an LLVM scalar or vector type
+         */
+        auto from_llvm(llvm::Type* type, bool is_unsigned) -> TypeInfo* {
+            if (type->isIntegerTy(1)) {
+                return m_TYPES.get_type("bool");
+            }
+            if (type->isIntegerTy()) {
+                return m_TYPES.get_integer_type(type, is_unsigned);
+            }
+            if (type->isFloatTy()) {
+                return m_TYPES.get_type("f32");
+            }
+            if (type->isDoubleTy()) {
+                return m_TYPES.get_type("double");
+            }
+            if (auto* vector_type = llvm::dyn_cast<llvm::FixedVectorType>(type)) {
+                auto* element_type = vector_type->getElementType();
+                std::string element = element_type->isFloatTy()    ? "f32"
+                                    : element_type->isDoubleTy() ? "f64"
+                                                                 : "i" + std::to_string(
+                                                                       element_type->getIntegerBitWidth());
+                return m_TYPES.get_type("v" + std::to_string(vector_type->getNumElements()) + element);
+            }
+            return nullptr;
+        }
+
+        static auto is_scalar(const TypeInfo* type) -> bool {
+            return type->kind == TypeKind::INT || type->kind == TypeKind::DOUBLE
+                || type->kind == TypeKind::BOOL;
+        }
+
+        /**
+         * @brief The type arithmetic on @p left and @p right produces; null if either is unknown
+         */
+        auto combine(TypeInfo* left, TypeInfo* right) -> TypeInfo* {
+            if (!left || !right) {
+                // A recursive call contributes nothing
+                return left ? left : right;
+            }
+            if (left->kind == TypeKind::VECTOR || right->kind == TypeKind::VECTOR) {
+                return left->kind == TypeKind::VECTOR ? left : right;
+            }
+            if (!is_scalar(left) || !is_scalar(right)) {
+                // Not arithmetic the generators accept; they report it
+                m_UNRESOLVED = true;
+                return nullptr;
+            }
+            auto* type = m_CONTEXT.common_type(
+                left->llvm_type, left->is_unsigned, right->llvm_type, right->is_unsigned);
+            const bool is_unsigned = left->kind == TypeKind::INT && right->kind == TypeKind::INT
+                && CompilationContext::common_unsigned(left->llvm_type->getIntegerBitWidth(),
+                                                       left->is_unsigned,
+                                                       right->llvm_type->getIntegerBitWidth(),
+                                                       right->is_unsigned);
+            return from_llvm(type, is_unsigned);
+        }
+
+        /**
+         * @brief The type of a branching form whose branches have types @p left and @p right
+         */
+        auto join(TypeInfo* left, TypeInfo* right, const std::string& form) -> TypeInfo* {
+            if (!left || !right || left == right) {
+                return left ? left : right;
+            }
+            const auto is_number = [](const TypeInfo* type)
+            { return type->kind == TypeKind::INT || type->kind == TypeKind::DOUBLE; };
+            if (!is_number(left) || !is_number(right)) {
+                if (m_CONFLICT.empty()) {
+                    m_CONFLICT = "branches of " + form + " have types " + left->name + " and " + right->name;
+                }
+                m_UNRESOLVED = true;
+                return nullptr;
+            }
+            return combine(left, right);
+        }
+
+        auto lookup(const std::string& name) -> TypeInfo* {
+            for (auto scope = m_SCOPES.rbegin(); scope != m_SCOPES.rend(); ++scope) {
+                auto it = scope->find(name);
+                if (it != scope->end()) {
+                    return it->second;
+                }
+            }
+            if (auto* var_info = m_CONTEXT.find_variable(name)) {
+                return var_info->type_info ? var_info->type_info : from_llvm(var_info->type, false);
+            }
+            m_UNRESOLVED = true;
+            return nullptr;
+        }
+
+        auto infer_scoped(const Exp& exp) -> TypeInfo* {
+            m_SCOPES.emplace_back();
+            auto* type = infer(exp);
+            m_SCOPES.pop_back();
+            return type;
+        }
+
+        auto infer_sequence(const Exp& exp) -> TypeInfo* {
+            m_SCOPES.emplace_back();
+            TypeInfo* type = m_TYPES.get_type("int");
+            for (size_t i = 1; i < exp.list.size(); ++i) {
+                type = infer(exp.list[i]);
+            }
+            m_SCOPES.pop_back();
+            return type;
+        }
+
+        auto infer_var(const Exp& exp) -> TypeInfo* {
+            const auto& name_exp = exp.list[1];
+            TypeInfo* type = nullptr;
+            std::string name = name_exp.string;
+            if (name_exp.type == ExpType::LIST && name_exp.list.size() == 2) {
+                name = name_exp.list[0].string;
+                type = m_TYPES.parse_type_spec(name_exp.list[1]);
+                if (type && type->kind == TypeKind::UNKNOWN) {
+                    type = nullptr;
+                }
+            }
+            if (exp.list.size() >= 3) {
+                auto* init_type = infer(exp.list[2]);
+                type = type ? type : init_type;
+            } else if (!type) {
+                type = m_TYPES.get_type("int");
+            }
+            m_SCOPES.back()[name] = type;
+            return type;
+        }
+
+        auto field_type(TypeInfo* container, const Exp& field_exp) -> TypeInfo* {
+            if (!container || !container->struct_info) {
+                return nullptr;
+            }
+            auto it = container->struct_info->field_indices.find(field_exp.string);
+            if (it == container->struct_info->field_indices.end()) {
+                return nullptr;
+            }
+            return container->struct_info->fields[it->second].type;
+        }
+
+        auto infer_call(const Exp& exp, const std::string& head) -> TypeInfo* {
+            if (head == m_FUNCTION) {
+                return nullptr;
+            }
+            auto* function = m_CONTEXT.find_function(head);
+            const auto dot = head.find('.');
+            if (!function && dot != std::string::npos) {
+                function = m_CONTEXT.find_function(head.substr(dot + 1));
+            }
+            if (!function) {
+                m_UNRESOLVED = true;
+                return nullptr;
+            }
+            for (size_t i = 1; i < exp.list.size(); ++i) {
+                infer(exp.list[i]);
+            }
+            return function->return_type;
+        }
+
+        auto infer_list(const Exp& exp) -> TypeInfo* {
+            if (exp.list.empty() || exp.list[0].type != ExpType::SYMBOL) {
+                return nullptr;
+            }
+
+            const std::string& head = exp.list[0].string;
+            const size_t size = exp.list.size();
+
+            if (head == "do" || head == "scope") {
+                return infer_sequence(exp);
+            }
+            if ((head == "var" || head == "global") && size >= 2) {
+                return infer_var(exp);
+            }
+            if (head == "set" && size == 3) {
+                infer(exp.list[2]);
+                return lookup(exp.list[1].string);
+            }
+            if (head == "if" && size >= 3) {
+                infer(exp.list[1]);
+                auto* then_type = infer_scoped(exp.list[2]);
+                return size >= 4 ? join(then_type, infer_scoped(exp.list[3]), head) : then_type;
+            }
+            if (head == "cond" || (head == "match" && size >= 2)) {
+                if (head == "match") {
+                    infer(exp.list[1]);
+                }
+                TypeInfo* type = nullptr;
+                for (size_t i = head == "match" ? 2 : 1; i < size; ++i) {
+                    const auto& clause = exp.list[i];
+                    if (clause.type == ExpType::LIST && clause.list.size() == 2) {
+                        type = join(type, infer_scoped(clause.list[1]), head);
+                    }
+                }
+                return type;
+            }
+            if (COMPARISONS.count(head) && size == 3) {
+                // Lane-wise on vectors: the result is a mask
+                for (size_t i = 1; i < size; ++i) {
+                    auto* operand = infer(exp.list[i]);
+                    if (operand && operand->kind == TypeKind::VECTOR) {
+                        auto* vector_type = llvm::cast<llvm::FixedVectorType>(operand->llvm_type);
+                        return m_TYPES.get_type("v" + std::to_string(vector_type->getNumElements()) + "i1");
+                    }
+                }
+                return m_TYPES.get_type("int");
+            }
+            if (INT_VALUED.count(head)) {
+                return m_TYPES.get_type("int");
+            }
+            if (ARITHMETIC.count(head) && size >= 2) {
+                TypeInfo* type = infer(exp.list[1]);
+                if (head == "rotl" || head == "rotr" || head == "abs" || head == "popcount" || head == "clz"
+                    || head == "ctz" || head == "bswap")
+                {
+                    return type;
+                }
+                for (size_t i = 2; i < size; ++i) {
+                    type = combine(type, infer(exp.list[i]));
+                }
+                return type;
+            }
+            if ((head == "<<" || head == ">>") && size == 3) {
+                infer(exp.list[2]);
+                return infer(exp.list[1]);
+            }
+            if (FLOATING_POINT.count(head)) {
+                TypeInfo* type = m_TYPES.get_type("double");
+                for (size_t i = 1; i < size; ++i) {
+                    auto* operand = infer(exp.list[i]);
+                    if (operand && operand->kind == TypeKind::VECTOR) {
+                        type = operand;
+                    }
+                }
+                return type;
+            }
+            if (LANE_VALUED.count(head) && size >= 2) {
+                auto* vector = infer(exp.list[1]);
+                if (!vector || vector->kind != TypeKind::VECTOR) {
+                    return nullptr;
+                }
+                // As CompilationContext::from_lane widens it
+                auto* element = llvm::cast<llvm::VectorType>(vector->llvm_type)->getElementType();
+                if (element->isFloatingPointTy()) {
+                    return m_TYPES.get_type("double");
+                }
+                return m_TYPES.get_type(element->getIntegerBitWidth() > 32 ? "i64" : "int");
+            }
+            if ((head == "cast" || head == "vec" || head == "splat") && size >= 2) {
+                return m_TYPES.parse_type_spec(exp.list[1]);
+            }
+            if ((head == "insert" || head == "select") && size >= 3) {
+                return infer(exp.list[head == "select" ? 2 : 1]);
+            }
+            if (head == "shuffle" && size >= 2) {
+                return infer(exp.list[1]);
+            }
+            if (head == "new" && size >= 2) {
+                return m_TYPES.get_type(exp.list[1].string);
+            }
+            if ((head == "getprop" || head == "setprop") && size >= 3) {
+                return field_type(infer(exp.list[1]), exp.list[2]);
+            }
+            if (head == "soa-vec" && size == 3) {
+                return m_TYPES.get_type(TypeSystem::soa_type_name(exp.list[1].string));
+            }
+            if (head == "soa-len") {
+                return m_TYPES.get_type("i64");
+            }
+            if ((head == "soa-get" || head == "soa-set") && size >= 4) {
+                return field_type(infer(exp.list[1]), exp.list[3]);
+            }
+            if (head == "defn" || head == "struct" || head == "extern" || head == "import"
+                || head == "defmodule" || head == "moduleuse")
+            {
+                return m_TYPES.get_type("int");
+            }
+            return infer_call(exp, head);
+        }
+
+      public:
+        explicit TypeInference(CompilationContext& context)
+            : m_CONTEXT(context)
+            , m_TYPES(*context.type_system)
+            , m_SCOPES(1) {}
+
+        /**
+         * @brief The type of @p exp in the current scope; null if it depends on something not known
+         */
+        auto infer(const Exp& exp) -> TypeInfo* {
+            switch (exp.type) {
+                case ExpType::NUMBER: {
+                    if (!exp.suffix.empty()) {
+                        return m_TYPES.get_type(exp.suffix);
+                    }
+                    const bool fits_int = exp.number >= INT32_MIN && exp.number <= INT32_MAX;
+                    return m_TYPES.get_type(fits_int ? "int" : "i64");
+                }
+                case ExpType::FRACTIONAL:
+                    return m_TYPES.get_type(exp.suffix == "f32" ? "f32" : "double");
+                case ExpType::STRING:
+                    return m_TYPES.get_type("str");
+                case ExpType::SYMBOL:
+                    if (exp.string == "true" || exp.string == "false") {
+                        return m_TYPES.get_type("bool");
+                    }
+                    return lookup(exp.string);
+                case ExpType::LIST:
+                    return infer_list(exp);
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief The return type of function @p name with @p params and @p body
+         *
+         * @return null if the body refers to functions or variables that are not declared yet, only
+         * returns through recursive calls or has branches of incompatible types (see conflict())
+         */
+        auto infer_return_type(const std::string& name,
+                               const std::vector<VariableInfo>& params,
+                               const Exp& body) -> TypeInfo* {
+            m_FUNCTION = name;
+            m_UNRESOLVED = false;
+            m_CONFLICT.clear();
+            m_SCOPES.emplace_back();
+            for (const auto& param : params) {
+                m_SCOPES.back()[param.name] = param.type_info;
+            }
+
+            auto* type = infer(body);
+            m_SCOPES.pop_back();
+            return m_UNRESOLVED ? nullptr : type;
+        }
+
+        /**
+         * @brief Why the last inference failed because of incompatible branches; empty otherwise
+         */
+        auto conflict() const -> const std::string& { return m_CONFLICT; }
+    };
+
+}    // namespace galluz::core
@@ -1,16 +1,22 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <optional>
 #include <stack>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include <llvm/IR/DataLayout.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Value.h>
+#include <llvm/Support/MathExtras.h>
 
+#include "../logger.hpp"
 #include "../parser/GalluzGrammar.h"
 
 namespace galluz::core {
@@ -23,6 +29,10 @@ namespace galluz::core {
         BOOL,
         VOID,
         STRUCT,
+        /// Fixed-width SIMD vector, named v<lanes><element> (v4f64, v8i32, v16i8, v4i1 for masks)
+        VECTOR,
+        /// Structure-of-arrays container of a struct, named soa-vec<Struct>; struct_info is the element
+        SOA,
         UNKNOWN
     };
 
@@ -31,14 +41,35 @@ namespace galluz::core {
     struct StructField {
         std::string name;
         TypeInfo* type;
+        /// Element of the LLVM struct to GEP; explicit padding elements make it differ from the position
         size_t index;
+        /// Requested alignment (:align), 0 for that of the type
+        unsigned align = 0;
+        /// Byte offset in the struct
+        uint64_t offset = 0;
     };
 
     struct StructInfo {
         std::string name;
         llvm::StructType* llvm_type;
+        /// In declaration order, whatever the layout; field_indices maps names to positions in it
         std::vector<StructField> fields;
         std::unordered_map<std::string, size_t> field_indices;
+        uint64_t size = 0;
+        unsigned align = 1;
+        bool packed = false;
+    };
+
+    /**
+     * @brief How define_struct lays out a struct
+     */
+    struct StructLayoutOptions {
+        /// No padding between fields (:packed)
+        bool packed = false;
+        /// Keep the declaration order, e.g. to match a struct declared in C (:ordered)
+        bool ordered = false;
+        /// Minimum alignment, e.g. 64 to give each instance a cache line of its own (:align 64)
+        unsigned align = 0;
     };
 
     struct TypeInfo {
@@ -47,6 +78,24 @@ namespace galluz::core {
         std::string name;
         bool is_reference = false;
         StructInfo* struct_info = nullptr;
+        /// u8 ... u64: division, remainder, right shift, comparisons and widening are unsigned
+        bool is_unsigned = false;
+
+        auto is_numeric() const -> bool { return kind == TypeKind::INT || kind == TypeKind::DOUBLE; }
+
+        /**
+         * @brief How C passes a value of this type in a register: bools and integers narrower than 32
+         * bits are extended by the caller, by their signedness
+         */
+        auto extension_attribute() const -> llvm::Attribute::AttrKind {
+            if (kind == TypeKind::BOOL) {
+                return llvm::Attribute::ZExt;
+            }
+            if (kind != TypeKind::INT || llvm_type->getIntegerBitWidth() >= 32) {
+                return llvm::Attribute::None;
+            }
+            return is_unsigned ? llvm::Attribute::ZExt : llvm::Attribute::SExt;
+        }
     };
 
     struct LoopContext {
@@ -56,6 +105,18 @@ namespace galluz::core {
         llvm::BasicBlock* exit_block;
     };
 
+    /**
+     * @brief What belongs to the function being generated, put aside while another one is generated
+     */
+    struct FunctionState {
+        llvm::Function* function;
+        llvm::BasicBlock* insert_block;
+        std::stack<LoopContext> loops;
+        std::unordered_set<const Exp*> tail_positions;
+        llvm::BasicBlock* tail_recurse_block;
+        std::vector<llvm::AllocaInst*> param_slots;
+    };
+
     class TypeSystem {
       private:
         std::unordered_map<std::string, TypeInfo> type_registry;
@@ -66,8 +127,58 @@ namespace galluz::core {
         explicit TypeSystem(llvm::LLVMContext& ctx)
             : context(ctx) {}
 
-        auto register_type(const std::string& name, TypeKind kind, llvm::Type* type) -> void {
-            type_registry[name] = {kind, type, name, false, nullptr};
+        auto register_type(const std::string& name, TypeKind kind, llvm::Type* type, bool is_unsigned = false)
+            -> void {
+            type_registry[name] = {kind, type, name, false, nullptr, is_unsigned};
+        }
+
+        /**
+         * @brief Register the sized scalars i8 ... i64, u8 ... u64, f32 and f64
+         *
+         * int and double stay the types of unsuffixed literals; they are i32 and f64 under another name.
+         */
+        auto register_sized_types() -> void {
+            for (unsigned bits : {8U, 16U, 32U, 64U}) {
+                auto* type = llvm::Type::getIntNTy(context, bits);
+                register_type("i" + std::to_string(bits), TypeKind::INT, type);
+                register_type("u" + std::to_string(bits), TypeKind::INT, type, true);
+            }
+            register_type("f32", TypeKind::DOUBLE, llvm::Type::getFloatTy(context));
+            register_type("f64", TypeKind::DOUBLE, llvm::Type::getDoubleTy(context));
+        }
+
+        /**
+         * @brief i8 ... i64 or u8 ... u64 for an integer of @p type (int for a signed i32)
+         */
+        auto get_integer_type(llvm::Type* type, bool is_unsigned) -> TypeInfo* {
+            const unsigned bits = type->getIntegerBitWidth();
+            if (bits == 32 && !is_unsigned) {
+                return get_type("int");
+            }
+            return get_type((is_unsigned ? "u" : "i") + std::to_string(bits));
+        }
+
+        /**
+         * @brief Register every v<lanes><element> type for 2 to 64 lanes of i1, i8, i16, i32, i64, f32 or f64
+         */
+        auto register_vector_types() -> void {
+            const std::pair<const char*, llvm::Type*> elements[] = {
+                {"i1", llvm::Type::getInt1Ty(context)},
+                {"i8", llvm::Type::getInt8Ty(context)},
+                {"i16", llvm::Type::getInt16Ty(context)},
+                {"i32", llvm::Type::getInt32Ty(context)},
+                {"i64", llvm::Type::getInt64Ty(context)},
+                {"f32", llvm::Type::getFloatTy(context)},
+                {"f64", llvm::Type::getDoubleTy(context)},
+            };
+
+            for (unsigned lanes = 2; lanes <= 64; lanes *= 2) {
+                for (const auto& [element_name, element_type] : elements) {
+                    register_type("v" + std::to_string(lanes) + element_name,
+                                  TypeKind::VECTOR,
+                                  llvm::FixedVectorType::get(element_type, lanes));
+                }
+            }
         }
 
         auto register_struct_type(const std::string& name, llvm::StructType* struct_type) -> void {
@@ -84,50 +195,130 @@ namespace galluz::core {
             type_registry[name] = type_info;
         }
 
+        /**
+         * @brief Alignment of a @p type in memory, including the :align of a struct
+         */
+        static auto alignment_of(const TypeInfo* type, const llvm::DataLayout& layout) -> uint64_t {
+            if (type->kind == TypeKind::STRUCT && type->struct_info) {
+                return type->struct_info->align;
+            }
+            return layout.getABITypeAlign(type->llvm_type).value();
+        }
+
+        /**
+         * @brief Define a struct and decide its layout
+         *
+         * Unless it is :packed or :ordered, fields are placed by decreasing alignment, in declaration
+         * order among equals, which leaves no padding between fields whose sizes are multiples of
+         * their alignment. A field with :align starts at a multiple of it and a struct with :align
+         * occupies a multiple of it; where LLVM would not put that padding itself, an i8 array
+         * element holds it.
+         */
         auto define_struct(const std::string& name,
-                           const std::vector<std::pair<std::string, TypeInfo*>>& fields) -> StructInfo* {
+                           std::vector<StructField> fields,
+                           const StructLayoutOptions& options,
+                           const llvm::DataLayout& layout) -> StructInfo* {
             auto it = struct_registry.find(name);
             if (it != struct_registry.end()) {
                 return &it->second;
             }
 
-            std::vector<llvm::Type*> field_types;
-            std::vector<StructField> struct_fields;
+            // Alignment LLVM gives the field on its own, and the one it must have
+            const auto llvm_align = [&](const StructField& field) -> uint64_t {
+                return options.packed ? 1 : layout.getABITypeAlign(field.type->llvm_type).value();
+            };
+            const auto wanted_align = [&](const StructField& field) -> uint64_t {
+                return std::max<uint64_t>(options.packed ? 1 : alignment_of(field.type, layout), field.align);
+            };
+
+            std::vector<size_t> order(fields.size());
+            std::iota(order.begin(), order.end(), 0);
+            if (!options.packed && !options.ordered) {
+                std::stable_sort(order.begin(),
+                                 order.end(),
+                                 [&](size_t a, size_t b)
+                                 { return wanted_align(fields[a]) > wanted_align(fields[b]); });
+            }
+
+            auto* byte_type = llvm::Type::getInt8Ty(context);
+            std::vector<llvm::Type*> elements;
+            uint64_t offset = 0;
+            uint64_t struct_align = std::max<uint64_t>(options.align, 1);
+            uint64_t llvm_struct_align = 1;
+
+            for (size_t position : order) {
+                auto& field = fields[position];
+                const uint64_t start = llvm::alignTo(offset, wanted_align(field));
+                if (start > llvm::alignTo(offset, llvm_align(field))) {
+                    elements.push_back(llvm::ArrayType::get(byte_type, start - offset));
+                }
 
-            for (size_t i = 0; i < fields.size(); ++i) {
-                const auto& [field_name, field_type] = fields[i];
-                field_types.push_back(field_type->llvm_type);
+                field.index = elements.size();
+                field.offset = start;
+                elements.push_back(field.type->llvm_type);
 
-                StructField field;
-                field.name = field_name;
-                field.type = field_type;
-                field.index = i;
-                struct_fields.push_back(field);
+                offset = start + layout.getTypeAllocSize(field.type->llvm_type);
+                struct_align = std::max(struct_align, wanted_align(field));
+                llvm_struct_align = std::max(llvm_struct_align, llvm_align(field));
             }
 
-            llvm::StructType* struct_type = llvm::StructType::create(context, field_types, name);
+            const uint64_t size = llvm::alignTo(offset, struct_align);
+            if (size > llvm::alignTo(offset, llvm_struct_align)) {
+                elements.push_back(llvm::ArrayType::get(byte_type, size - offset));
+            }
 
             StructInfo struct_info;
             struct_info.name = name;
-            struct_info.llvm_type = struct_type;
-            struct_info.fields = struct_fields;
-
-            for (size_t i = 0; i < struct_fields.size(); ++i) {
-                struct_info.field_indices[struct_fields[i].name] = i;
+            struct_info.llvm_type = llvm::StructType::create(context, elements, name, options.packed);
+            struct_info.fields = std::move(fields);
+            struct_info.size = size;
+            struct_info.align = static_cast<unsigned>(struct_align);
+            struct_info.packed = options.packed;
+
+            for (size_t i = 0; i < struct_info.fields.size(); ++i) {
+                struct_info.field_indices[struct_info.fields[i].name] = i;
             }
 
             struct_registry[name] = struct_info;
 
             TypeInfo type_info;
             type_info.kind = TypeKind::STRUCT;
-            type_info.llvm_type = struct_type;
+            type_info.llvm_type = struct_info.llvm_type;
             type_info.name = name;
             type_info.struct_info = &struct_registry[name];
             type_registry[name] = type_info;
 
+            // (soa-vec name n) holds {length, column of field 0, column of field 1, ...}
+            std::vector<llvm::Type*> columns = {llvm::Type::getInt64Ty(context)};
+            for (const auto& field : struct_info.fields) {
+                columns.push_back(field.type->llvm_type->getPointerTo());
+            }
+            TypeInfo soa_type;
+            soa_type.kind = TypeKind::SOA;
+            soa_type.name = soa_type_name(name);
+            soa_type.llvm_type = llvm::StructType::create(context, columns, soa_type.name);
+            soa_type.struct_info = &struct_registry[name];
+            type_registry[soa_type.name] = soa_type;
+
             return &struct_registry[name];
         }
 
+        static auto soa_type_name(const std::string& struct_name) -> std::string {
+            return "soa-vec<" + struct_name + ">";
+        }
+
+        /**
+         * @brief The soa-vec type whose LLVM type is @p type, if it is one
+         */
+        auto get_soa_type(llvm::Type* type) -> TypeInfo* {
+            auto* struct_type = llvm::dyn_cast<llvm::StructType>(type);
+            if (!struct_type || !struct_type->hasName()) {
+                return nullptr;
+            }
+            auto* type_info = get_type(struct_type->getName().str());
+            return type_info && type_info->kind == TypeKind::SOA ? type_info : nullptr;
+        }
+
         auto get_struct_info(const std::string& name) -> StructInfo* {
             auto it = struct_registry.find(name);
             if (it != struct_registry.end()) {
@@ -246,6 +437,17 @@ namespace galluz::core {
         std::stack<std::unique_ptr<Scope>> scopes;
         std::stack<LoopContext> loop_stack;
         Scope* current_scope;
+        /// Emit nsw on signed integer add/sub/mul/neg (--no-signed-wrap)
+        bool assume_no_signed_wrap = false;
+        /// Log the layout of each struct as it is defined (--struct-layout)
+        bool report_struct_layout = false;
+        /// Expressions in tail position of the defn being generated
+        std::unordered_set<const Exp*> tail_positions;
+        /// Loop header that self tail calls of the current defn branch to, with its parameter slots
+        llvm::BasicBlock* tail_recurse_block = nullptr;
+        std::vector<llvm::AllocaInst*> param_slots;
+        /// Prototypes made by the declaration pass whose defn has not been generated yet
+        std::unordered_set<llvm::Function*> pending_prototypes;
 
         CompilationContext(llvm::LLVMContext& ctx,
                            llvm::Module& module,
@@ -269,13 +471,48 @@ namespace galluz::core {
 
         auto pop_scope() -> void {
             if (!scopes.empty()) {
+                // The parent, not the new top: a module body is generated inside a scope off the stack
+                current_scope = scopes.top()->parent;
                 scopes.pop();
-                current_scope = scopes.empty() ? nullptr : scopes.top().get();
             }
         }
 
         auto get_current_scope() -> Scope* { return current_scope; }
 
+        /**
+         * @brief Start generating @p function: its caller's loops and tail-call state do not apply
+         *
+         * @return the caller's state, for leave_function()
+         */
+        auto enter_function(llvm::Function* function) -> FunctionState {
+            FunctionState caller {m_CURRENT_FUNCTION,
+                                  m_BUILDER.GetInsertBlock(),
+                                  std::move(loop_stack),
+                                  std::move(tail_positions),
+                                  tail_recurse_block,
+                                  std::move(param_slots)};
+            m_CURRENT_FUNCTION = function;
+            loop_stack = {};
+            tail_positions.clear();
+            tail_recurse_block = nullptr;
+            param_slots.clear();
+            return caller;
+        }
+
+        /**
+         * @brief Continue generating the caller put aside by enter_function()
+         */
+        auto leave_function(FunctionState& caller) -> void {
+            m_CURRENT_FUNCTION = caller.function;
+            loop_stack = std::move(caller.loops);
+            tail_positions = std::move(caller.tail_positions);
+            tail_recurse_block = caller.tail_recurse_block;
+            param_slots = std::move(caller.param_slots);
+            if (caller.insert_block) {
+                m_BUILDER.SetInsertPoint(caller.insert_block);
+            }
+        }
+
         auto find_variable(const std::string& name) -> VariableInfo* {
             Scope* scope = current_scope;
             while (scope) {
@@ -341,6 +578,340 @@ namespace galluz::core {
             return false;
         }
 
+        /**
+         * @brief Stack slot in the entry block of the current function
+         *
+         * Keeping every alloca in the entry block lets mem2reg promote it and keeps loops from
+         * growing the stack on each iteration.
+         */
+        auto create_entry_alloca(llvm::Type* type, const std::string& name) -> llvm::AllocaInst* {
+            auto& entry = m_CURRENT_FUNCTION->getEntryBlock();
+            llvm::IRBuilder<> entry_builder(&entry, entry.begin());
+            return entry_builder.CreateAlloca(type, nullptr, name);
+        }
+
+        /**
+         * @brief Let the next form of a sequence follow one that ended its block
+         *
+         * After a break, continue, tail call or a branch no path leaves, the code that follows can
+         * never run; it goes to a fresh block without predecessors instead of after the terminator.
+         */
+        auto continue_after_terminator() -> void {
+            llvm::BasicBlock* block = m_BUILDER.GetInsertBlock();
+            if (block && block->getTerminator()) {
+                m_BUILDER.SetInsertPoint(llvm::BasicBlock::Create(m_CTX, "dead", block->getParent()));
+            }
+        }
+
+        /**
+         * @brief Alignment of a @p type value in memory, raised to the :align of its struct if it is one
+         */
+        auto memory_alignment(llvm::Type* type, const TypeInfo* type_info = nullptr) const -> llvm::Align {
+            const llvm::Align natural = m_MODULE.getDataLayout().getABITypeAlign(type);
+            if (type_info && type_info->kind == TypeKind::STRUCT && type_info->struct_info) {
+                return std::max(natural, llvm::Align(type_info->struct_info->align));
+            }
+            return natural;
+        }
+
+        /**
+         * @brief Convert a scalar to the element type of a vector lane
+         */
+        auto to_lane(llvm::Value* scalar, llvm::Type* element_type) -> llvm::Value* {
+            llvm::Type* type = scalar->getType();
+            if (type == element_type) {
+                return scalar;
+            }
+            if (type->isIntegerTy() && element_type->isIntegerTy()) {
+                return m_BUILDER.CreateIntCast(scalar, element_type, !type->isIntegerTy(1));
+            }
+            if (type->isIntegerTy() && element_type->isFloatingPointTy()) {
+                return m_BUILDER.CreateSIToFP(scalar, element_type);
+            }
+            if (type->isFloatingPointTy() && element_type->isFloatingPointTy()) {
+                return m_BUILDER.CreateFPCast(scalar, element_type);
+            }
+            if (type->isFloatingPointTy() && element_type->isIntegerTy()) {
+                return m_BUILDER.CreateFPToSI(scalar, element_type);
+            }
+            LOG_CRITICAL("Cannot use a value of this type as a vector lane");
+            return scalar;
+        }
+
+        /**
+         * @brief Broadcast a scalar to every lane of @p vector_type
+         */
+        auto splat(llvm::Value* scalar, llvm::VectorType* vector_type) -> llvm::Value* {
+            auto* fixed_type = llvm::cast<llvm::FixedVectorType>(vector_type);
+            return m_BUILDER.CreateVectorSplat(fixed_type->getNumElements(),
+                                               to_lane(scalar, fixed_type->getElementType()));
+        }
+
+        /**
+         * @brief Widen a lane to a scalar of the language: masks and narrow integers to int, i64 stays
+         * i64, floats to double
+         */
+        auto from_lane(llvm::Value* element) -> llvm::Value* {
+            llvm::Type* type = element->getType();
+            if (type->isIntegerTy(1)) {
+                return m_BUILDER.CreateZExt(element, m_BUILDER.getInt32Ty());
+            }
+            if (type->isIntegerTy() && type->getIntegerBitWidth() < 32) {
+                return m_BUILDER.CreateSExt(element, m_BUILDER.getInt32Ty());
+            }
+            if (type->isFloatTy()) {
+                return m_BUILDER.CreateFPExt(element, m_BUILDER.getDoubleTy());
+            }
+            return element;
+        }
+
+        /**
+         * @brief Type of the field @p expr reads with getprop or soa-get; null for anything else
+         */
+        auto field_type(const Exp& expr) -> TypeInfo* {
+            const std::string& head = expr.list[0].string;
+            const bool is_getprop = head == "getprop" && expr.list.size() == 3;
+            const bool is_soa_get = head == "soa-get" && expr.list.size() == 4;
+            if ((!is_getprop && !is_soa_get) || expr.list[1].type != ExpType::SYMBOL) {
+                return nullptr;
+            }
+            auto* var_info = find_variable(expr.list[1].string);
+            if (!var_info || !var_info->type_info || !var_info->type_info->struct_info
+                || (var_info->type_info->kind == TypeKind::SOA) != is_soa_get)
+            {
+                return nullptr;
+            }
+            auto* struct_info = var_info->type_info->struct_info;
+            auto it = struct_info->field_indices.find(expr.list.back().string);
+            return it != struct_info->field_indices.end() ? struct_info->fields[it->second].type : nullptr;
+        }
+
+        /**
+         * @brief Bit width of @p expr if it is an integer whose type can be read off the source,
+         * 0 otherwise
+         */
+        auto integer_width(const Exp& expr) -> unsigned {
+            const auto width_of = [](llvm::Type* type) -> unsigned
+            { return type && type->isIntegerTy() ? type->getIntegerBitWidth() : 0; };
+
+            if (expr.type == ExpType::NUMBER) {
+                if (expr.suffix.empty()) {
+                    return llvm::isInt<32>(expr.number) ? 32 : 64;
+                }
+                auto* type = type_system->get_type(expr.suffix);
+                return type ? width_of(type->llvm_type) : 0;
+            }
+            if (expr.type == ExpType::SYMBOL) {
+                auto* var_info = find_variable(expr.string);
+                return var_info ? width_of(var_info->type) : 0;
+            }
+            if (expr.type != ExpType::LIST || expr.list.size() < 2 || expr.list[0].type != ExpType::SYMBOL) {
+                return 0;
+            }
+
+            static const std::unordered_set<std::string> combining = {"+", "-", "*", "/", "%", "min", "max"};
+            static const std::unordered_set<std::string> first_operand = {
+                "<<", ">>", "abs", "rotl", "rotr", "bswap", "popcount", "clz", "ctz"};
+            static const std::unordered_set<std::string> int_valued = {
+                "<", ">", "<=", ">=", "==", "!=", "and", "or", "not"};
+
+            const std::string& head = expr.list[0].string;
+            if (combining.count(head)) {
+                unsigned width = 0;
+                for (size_t i = 1; i < expr.list.size(); ++i) {
+                    const unsigned operand = integer_width(expr.list[i]);
+                    if (operand == 0) {
+                        return 0;
+                    }
+                    width = std::max(width, operand);
+                }
+                return width;
+            }
+            if (first_operand.count(head)) {
+                return integer_width(expr.list[1]);
+            }
+            if (int_valued.count(head)) {
+                return 32;
+            }
+            if (head == "soa-len") {
+                return 64;
+            }
+            if (head == "cast" && expr.list.size() == 3) {
+                auto* type = type_system->parse_type_spec(expr.list[1]);
+                return type ? width_of(type->llvm_type) : 0;
+            }
+            if (auto* field = field_type(expr)) {
+                return width_of(field->llvm_type);
+            }
+            auto* function = find_function(head);
+            return function && function->return_type ? width_of(function->return_type->llvm_type) : 0;
+        }
+
+        /**
+         * @brief Whether an operation on a @p left_width and a @p right_width bit integer is unsigned
+         *
+         * C's usual arithmetic conversions: two unsigned operands stay unsigned. With one of each,
+         * the operation is unsigned only if the unsigned operand is at least as wide as the signed
+         * one and at least as wide as an int; otherwise the unsigned operand is zero-extended and
+         * the operation is signed, so (< -10 2u8) is 1 and (/ -10i64 3u32) is -3.
+         */
+        static auto common_unsigned(unsigned left_width,
+                                    bool left_unsigned,
+                                    unsigned right_width,
+                                    bool right_unsigned) -> bool {
+            if (left_unsigned == right_unsigned) {
+                return left_unsigned;
+            }
+            const unsigned unsigned_width = left_unsigned ? left_width : right_width;
+            const unsigned signed_width = left_unsigned ? right_width : left_width;
+            return unsigned_width >= signed_width && unsigned_width >= 32;
+        }
+
+        /**
+         * @brief Whether @p expr is of an unsigned integer type
+         *
+         * LLVM integers carry no sign, so it is read off the source: a u-suffixed literal; a
+         * variable, field or function result declared u8 ... u64; a cast to one of them; or
+         * arithmetic whose operands meet in an unsigned type (see common_unsigned; for shifts and
+         * the unary builtins, the first operand decides).
+         */
+        auto is_unsigned(const Exp& expr) -> bool {
+            if (expr.type == ExpType::NUMBER) {
+                return !expr.suffix.empty() && expr.suffix[0] == 'u';
+            }
+            if (expr.type == ExpType::SYMBOL) {
+                auto* var_info = find_variable(expr.string);
+                return var_info && var_info->type_info && var_info->type_info->is_unsigned;
+            }
+            if (expr.type != ExpType::LIST || expr.list.empty() || expr.list[0].type != ExpType::SYMBOL) {
+                return false;
+            }
+
+            static const std::unordered_set<std::string> combining = {"+", "-", "*", "/", "%", "min", "max"};
+            static const std::unordered_set<std::string> first_operand = {
+                "<<", ">>", "abs", "rotl", "rotr", "bswap"};
+
+            const std::string& head = expr.list[0].string;
+            if (combining.count(head)) {
+                if (expr.list.size() < 2) {
+                    return false;
+                }
+                unsigned width = integer_width(expr.list[1]);
+                bool result = is_unsigned(expr.list[1]);
+                for (size_t i = 2; i < expr.list.size(); ++i) {
+                    const unsigned operand_width = integer_width(expr.list[i]);
+                    result = common_unsigned(width, result, operand_width, is_unsigned(expr.list[i]));
+                    width = std::max(width, operand_width);
+                }
+                return result;
+            }
+            if (first_operand.count(head)) {
+                return expr.list.size() > 1 && is_unsigned(expr.list[1]);
+            }
+            if (head == "cast" && expr.list.size() == 3) {
+                auto* type = type_system->parse_type_spec(expr.list[1]);
+                return type && type->is_unsigned;
+            }
+            if (auto* field = field_type(expr)) {
+                return field->is_unsigned;
+            }
+            auto* function = find_function(head);
+            return function && function->return_type && function->return_type->is_unsigned;
+        }
+
+        /**
+         * @brief Convert a scalar between integer, floating point and bool types
+         *
+         * Integers are extended and converted by the signedness of the source, floating point
+         * values are converted to integers by the signedness of the target, and anything becomes
+         * a bool by comparing it against zero.
+         */
+        auto convert_scalar(llvm::Value* value, bool is_unsigned, llvm::Type* type, bool to_unsigned)
+            -> llvm::Value* {
+            llvm::Type* from = value->getType();
+            if (from == type) {
+                return value;
+            }
+            // Bools are never negative
+            is_unsigned = is_unsigned || from->isIntegerTy(1);
+
+            if (type->isIntegerTy(1)) {
+                if (from->isFloatingPointTy()) {
+                    return m_BUILDER.CreateFCmpUNE(value, llvm::ConstantFP::get(from, 0.0));
+                }
+                return m_BUILDER.CreateICmpNE(value, llvm::ConstantInt::get(from, 0));
+            }
+            if (from->isIntegerTy() && type->isIntegerTy()) {
+                return m_BUILDER.CreateIntCast(value, type, !is_unsigned);
+            }
+            if (from->isIntegerTy() && type->isFloatingPointTy()) {
+                return is_unsigned ? m_BUILDER.CreateUIToFP(value, type)
+                                   : m_BUILDER.CreateSIToFP(value, type);
+            }
+            if (from->isFloatingPointTy() && type->isFloatingPointTy()) {
+                return m_BUILDER.CreateFPCast(value, type);
+            }
+            if (from->isFloatingPointTy() && type->isIntegerTy()) {
+                return to_unsigned ? m_BUILDER.CreateFPToUI(value, type)
+                                   : m_BUILDER.CreateFPToSI(value, type);
+            }
+            LOG_CRITICAL("Cannot convert this value to a number");
+            return value;
+        }
+
+        /**
+         * @brief The type two scalars are brought to before they are combined
+         *
+         * Two integers meet in the wider of them. A signed and an unsigned one that combine as
+         * signed (see common_unsigned) meet in at least an int, so that the unsigned value keeps its
+         * magnitude. Otherwise it is the widest floating point type among them (an integer mixed
+         * with f32 becomes f32).
+         */
+        auto common_type(llvm::Type* left_type,
+                         bool left_unsigned,
+                         llvm::Type* right_type,
+                         bool right_unsigned) -> llvm::Type* {
+            if (left_type->isIntegerTy() && right_type->isIntegerTy()) {
+                const unsigned left_width = left_type->getIntegerBitWidth();
+                const unsigned right_width = right_type->getIntegerBitWidth();
+                llvm::Type* wider = left_width >= right_width ? left_type : right_type;
+                if (left_unsigned != right_unsigned
+                    && !common_unsigned(left_width, left_unsigned, right_width, right_unsigned)
+                    && wider->getIntegerBitWidth() < 32)
+                {
+                    return m_BUILDER.getInt32Ty();
+                }
+                return wider;
+            }
+            if (left_type->isDoubleTy() || right_type->isDoubleTy()) {
+                return m_BUILDER.getDoubleTy();
+            }
+            return m_BUILDER.getFloatTy();
+        }
+
+        /**
+         * @brief Convert two scalar operands to their common_type, each by its own signedness
+         *
+         * @return bool Whether the operation on them is unsigned
+         */
+        auto to_common_type(llvm::Value*& left,
+                            bool left_unsigned,
+                            llvm::Value*& right,
+                            bool right_unsigned) -> bool {
+            llvm::Type* left_type = left->getType();
+            llvm::Type* right_type = right->getType();
+            llvm::Type* type = common_type(left_type, left_unsigned, right_type, right_unsigned);
+            left = convert_scalar(left, left_unsigned, type, false);
+            right = convert_scalar(right, right_unsigned, type, false);
+            if (!left_type->isIntegerTy() || !right_type->isIntegerTy()) {
+                return false;
+            }
+            return common_unsigned(left_type->getIntegerBitWidth(),
+                                   left_unsigned,
+                                   right_type->getIntegerBitWidth(),
+                                   right_unsigned);
+        }
+
         auto push_loop(const LoopContext& loop) -> void { loop_stack.push(loop); }
 
         auto pop_loop() -> void {
@@ -357,6 +928,20 @@ namespace galluz::core {
         }
     };
 
+    /**
+     * @brief Passes run over the forms of a block before any of them is generated
+     *
+     * All types of a block are known before any signature is resolved, and all signatures before
+     * any body, so forms may refer to definitions that come after them. Return types left to
+     * inference are worked out last, once the signatures they may depend on are known.
+     */
+    enum class DeclarationPass : uint8_t
+    {
+        TYPES,
+        SIGNATURES,
+        INFERRED_SIGNATURES
+    };
+
     class ICodeGenerator {
       public:
         virtual ~ICodeGenerator() = default;
@@ -364,6 +949,15 @@ namespace galluz::core {
         virtual auto can_handle(const Exp& ast_node) const -> bool = 0;
         virtual auto generate(const Exp& ast_node, CompilationContext& context) -> llvm::Value* = 0;
         virtual auto get_priority() const -> int = 0;
+
+        /**
+         * @brief Register what the form defines for its siblings, without generating any code
+         *
+         * Malformed forms are left alone here; generate() reports them in source order.
+         */
+        virtual auto declare(const Exp& /*ast_node*/,
+                             CompilationContext& /*context*/,
+                             DeclarationPass /*pass*/) -> void {}
     };
 
 }    // namespace galluz::core
@@ -4,6 +4,7 @@
 
 #include "../core/generator_manager.hpp"
 #include "../core/types.hpp"
+#include "../logger.hpp"
 
 namespace galluz::generators {
 
@@ -15,11 +16,93 @@ namespace galluz::generators {
 
         auto is_floating_type(llvm::Value* value) -> bool { return value->getType()->isFloatingPointTy(); }
 
-        auto promote_to_double(llvm::Value* value, core::CompilationContext& context) -> llvm::Value* {
-            if (is_integer_type(value)) {
-                return context.m_BUILDER.CreateSIToFP(value, context.m_BUILDER.getDoubleTy());
+        /**
+         * @brief Lane-wise operation on vectors; a scalar operand is broadcast to every lane
+         */
+        auto generate_vector_op(const std::string& op,
+                                llvm::Value* left,
+                                llvm::Value* right,
+                                core::CompilationContext& context) -> llvm::Value* {
+            if (!left->getType()->isVectorTy()) {
+                left = context.splat(left, llvm::cast<llvm::VectorType>(right->getType()));
+            } else if (!right->getType()->isVectorTy()) {
+                right = context.splat(right, llvm::cast<llvm::VectorType>(left->getType()));
             }
-            return value;
+
+            if (left->getType() != right->getType()) {
+                LOG_CRITICAL("Operands of %s must be vectors of the same type", op);
+            }
+
+            const bool nsw = context.assume_no_signed_wrap;
+            if (left->getType()->isIntOrIntVectorTy()) {
+                if (op == "+") {
+                    return context.m_BUILDER.CreateAdd(left, right, "", false, nsw);
+                }
+                if (op == "-") {
+                    return context.m_BUILDER.CreateSub(left, right, "", false, nsw);
+                }
+                if (op == "*") {
+                    return context.m_BUILDER.CreateMul(left, right, "", false, nsw);
+                }
+                if (op == "/") {
+                    return context.m_BUILDER.CreateSDiv(left, right);
+                }
+                if (op == "<<") {
+                    return context.m_BUILDER.CreateShl(left, right);
+                }
+                if (op == ">>") {
+                    return context.m_BUILDER.CreateAShr(left, right);
+                }
+                return context.m_BUILDER.CreateSRem(left, right);
+            }
+
+            if (op == "+") {
+                return context.m_BUILDER.CreateFAdd(left, right);
+            }
+            if (op == "-") {
+                return context.m_BUILDER.CreateFSub(left, right);
+            }
+            if (op == "*") {
+                return context.m_BUILDER.CreateFMul(left, right);
+            }
+            if (op == "/") {
+                return context.m_BUILDER.CreateFDiv(left, right);
+            }
+            LOG_CRITICAL("%s is not supported for floating point", op == "%" ? "Modulo operation" : op);
+            return nullptr;
+        }
+
+        /**
+         * @brief One integer operation; division, remainder and right shift follow @p is_unsigned
+         */
+        auto generate_integer_op(const std::string& op,
+                                 llvm::Value* left,
+                                 llvm::Value* right,
+                                 bool is_unsigned,
+                                 core::CompilationContext& context) -> llvm::Value* {
+            auto& builder = context.m_BUILDER;
+            // Unsigned arithmetic wraps by definition
+            const bool nsw = context.assume_no_signed_wrap && !is_unsigned;
+
+            if (op == "+") {
+                return builder.CreateAdd(left, right, "", false, nsw);
+            }
+            if (op == "-") {
+                return builder.CreateSub(left, right, "", false, nsw);
+            }
+            if (op == "*") {
+                return builder.CreateMul(left, right, "", false, nsw);
+            }
+            if (op == "/") {
+                return is_unsigned ? builder.CreateUDiv(left, right) : builder.CreateSDiv(left, right);
+            }
+            if (op == "%") {
+                return is_unsigned ? builder.CreateURem(left, right) : builder.CreateSRem(left, right);
+            }
+            if (op == "<<") {
+                return builder.CreateShl(left, right);
+            }
+            return is_unsigned ? builder.CreateLShr(left, right) : builder.CreateAShr(left, right);
         }
 
       public:
@@ -40,7 +123,7 @@ namespace galluz::generators {
             }
 
             const std::string& op = first.string;
-            return op == "+" || op == "-" || op == "*" || op == "/" || op == "%";
+            return op == "+" || op == "-" || op == "*" || op == "/" || op == "%" || op == "<<" || op == ">>";
         }
 
         auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
@@ -64,8 +147,9 @@ namespace galluz::generators {
                     return operands[0];
                 }
                 if (op == "-") {
-                    if (is_integer_type(operands[0])) {
-                        return context.m_BUILDER.CreateNeg(operands[0]);
+                    if (operands[0]->getType()->isIntOrIntVectorTy()) {
+                        const bool nsw = context.assume_no_signed_wrap && !context.is_unsigned(ast_node);
+                        return context.m_BUILDER.CreateNeg(operands[0], "", false, nsw);
                     } else {
                         llvm::Value* zero = llvm::ConstantFP::get(operands[0]->getType(), 0.0);
                         return context.m_BUILDER.CreateFSub(zero, operands[0]);
@@ -74,43 +158,49 @@ namespace galluz::generators {
                 return operands[0];
             }
 
+            const bool is_shift = op == "<<" || op == ">>";
+
             llvm::Value* result = operands[0];
+            bool result_unsigned = context.is_unsigned(ast_node.list[1]);
 
             for (size_t i = 1; i < operands.size(); ++i) {
                 llvm::Value* left = result;
                 llvm::Value* right = operands[i];
 
-                bool left_int = is_integer_type(left);
-                bool right_int = is_integer_type(right);
+                if (left->getType()->isVectorTy() || right->getType()->isVectorTy()) {
+                    result = generate_vector_op(op, left, right, context);
+                    continue;
+                }
 
-                if (left_int && right_int) {
-                    if (op == "+") {
-                        result = context.m_BUILDER.CreateAdd(left, right);
-                    } else if (op == "-") {
-                        result = context.m_BUILDER.CreateSub(left, right);
-                    } else if (op == "*") {
-                        result = context.m_BUILDER.CreateMul(left, right);
-                    } else if (op == "/") {
-                        result = context.m_BUILDER.CreateSDiv(left, right);
-                    } else if (op == "%") {
-                        result = context.m_BUILDER.CreateSRem(left, right);
+                const bool right_unsigned = context.is_unsigned(ast_node.list[i + 1]);
+
+                bool is_unsigned = result_unsigned;
+                if (is_shift) {
+                    if (!is_integer_type(left) || !is_integer_type(right)) {
+                        LOG_CRITICAL("Operands of %s must be integers", op);
                     }
+                    // The shifted value keeps its type and signedness; the amount is brought to it
+                    right = context.convert_scalar(right, right_unsigned, left->getType(), false);
                 } else {
-                    llvm::Value* left_fp = promote_to_double(left, context);
-                    llvm::Value* right_fp = promote_to_double(right, context);
+                    is_unsigned = context.to_common_type(left, result_unsigned, right, right_unsigned);
+                }
 
+                if (is_integer_type(left)) {
+                    result = generate_integer_op(op, left, right, is_unsigned, context);
+                } else {
                     if (op == "+") {
-                        result = context.m_BUILDER.CreateFAdd(left_fp, right_fp);
+                        result = context.m_BUILDER.CreateFAdd(left, right);
                     } else if (op == "-") {
-                        result = context.m_BUILDER.CreateFSub(left_fp, right_fp);
+                        result = context.m_BUILDER.CreateFSub(left, right);
                     } else if (op == "*") {
-                        result = context.m_BUILDER.CreateFMul(left_fp, right_fp);
+                        result = context.m_BUILDER.CreateFMul(left, right);
                     } else if (op == "/") {
-                        result = context.m_BUILDER.CreateFDiv(left_fp, right_fp);
+                        result = context.m_BUILDER.CreateFDiv(left, right);
                     } else if (op == "%") {
                         LOG_CRITICAL("Modulo operation not supported for floating point");
                     }
                 }
+                result_unsigned = is_unsigned;
             }
 
             return result;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../core/generator_manager.hpp"
+#include "../core/types.hpp"
+#include "../logger.hpp"
+
+namespace galluz::generators {
+
+    /**
+     * @brief Explicit conversion between scalar types: (cast !type value)
+     *
+     * Integers are truncated or extended (sign- or zero- by the signedness of the value), converted
+     * to and from floating point, and f32 and f64 converted into each other. A cast to bool tests
+     * for non-zero. Arithmetic widens implicitly but never narrows; cast is how a result is stored
+     * back into a smaller type without going through a typed variable.
+     */
+    class CastGenerator : public core::ICodeGenerator {
+      private:
+        core::GeneratorManager* m_GENERATOR_MANAGER;
+
+      public:
+        explicit CastGenerator(core::GeneratorManager* manager)
+            : m_GENERATOR_MANAGER(manager) {}
+
+        auto can_handle(const Exp& ast_node) const -> bool override {
+            return ast_node.type == ExpType::LIST && !ast_node.list.empty()
+                && ast_node.list[0].type == ExpType::SYMBOL && ast_node.list[0].string == "cast";
+        }
+
+        auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
+            if (ast_node.list.size() != 3) {
+                LOG_CRITICAL("Invalid cast: (cast !type value)");
+            }
+
+            auto* type = context.type_system->parse_type_spec(ast_node.list[1]);
+            if (!type
+                || (type->kind != core::TypeKind::INT && type->kind != core::TypeKind::DOUBLE
+                    && type->kind != core::TypeKind::BOOL))
+            {
+                LOG_CRITICAL("cast converts to integer, floating point or bool types, not %s",
+                             ast_node.list[1].string);
+            }
+
+            llvm::Value* value = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
+            if (!value->getType()->isIntegerTy() && !value->getType()->isFloatingPointTy()) {
+                LOG_CRITICAL("cast expects a number or a bool to convert");
+            }
+
+            return context.convert_scalar(
+                value, context.is_unsigned(ast_node.list[2]), type->llvm_type, type->is_unsigned);
+        }
+
+        auto get_priority() const -> int override { return 450; }
+    };
+
+}    // namespace galluz::generators
@@ -2,6 +2,7 @@
 
 #include "../core/generator_manager.hpp"
 #include "../core/types.hpp"
+#include "../logger.hpp"
 
 namespace galluz::generators {
 
@@ -13,11 +14,40 @@ namespace galluz::generators {
 
         auto is_floating_type(llvm::Value* value) -> bool { return value->getType()->isFloatingPointTy(); }
 
-        auto promote_to_double(llvm::Value* value, core::CompilationContext& context) -> llvm::Value* {
-            if (is_integer_type(value)) {
-                return context.m_BUILDER.CreateSIToFP(value, context.m_BUILDER.getDoubleTy());
+        /**
+         * @brief Lane-wise comparison producing a mask vector; a scalar operand is broadcast
+         */
+        auto generate_vector_comparison(const std::string& op,
+                                        llvm::Value* left,
+                                        llvm::Value* right,
+                                        core::CompilationContext& context) -> llvm::Value* {
+            if (!left->getType()->isVectorTy()) {
+                left = context.splat(left, llvm::cast<llvm::VectorType>(right->getType()));
+            } else if (!right->getType()->isVectorTy()) {
+                right = context.splat(right, llvm::cast<llvm::VectorType>(left->getType()));
             }
-            return value;
+
+            if (left->getType() != right->getType()) {
+                LOG_CRITICAL("Operands of %s must be vectors of the same type", op);
+            }
+
+            const bool is_int = left->getType()->isIntOrIntVectorTy();
+            llvm::CmpInst::Predicate predicate = llvm::CmpInst::BAD_ICMP_PREDICATE;
+            if (op == ">") {
+                predicate = is_int ? llvm::CmpInst::ICMP_SGT : llvm::CmpInst::FCMP_OGT;
+            } else if (op == "<") {
+                predicate = is_int ? llvm::CmpInst::ICMP_SLT : llvm::CmpInst::FCMP_OLT;
+            } else if (op == ">=") {
+                predicate = is_int ? llvm::CmpInst::ICMP_SGE : llvm::CmpInst::FCMP_OGE;
+            } else if (op == "<=") {
+                predicate = is_int ? llvm::CmpInst::ICMP_SLE : llvm::CmpInst::FCMP_OLE;
+            } else if (op == "==") {
+                predicate = is_int ? llvm::CmpInst::ICMP_EQ : llvm::CmpInst::FCMP_OEQ;
+            } else if (op == "!=") {
+                predicate = is_int ? llvm::CmpInst::ICMP_NE : llvm::CmpInst::FCMP_ONE;
+            }
+
+            return context.m_BUILDER.CreateCmp(predicate, left, right);
         }
 
       public:
@@ -51,41 +81,47 @@ namespace galluz::generators {
             llvm::Value* left = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
             llvm::Value* right = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
 
-            bool left_int = is_integer_type(left);
-            bool right_int = is_integer_type(right);
+            if (left->getType()->isVectorTy() || right->getType()->isVectorTy()) {
+                return generate_vector_comparison(op, left, right, context);
+            }
+
+            const bool left_unsigned = context.is_unsigned(ast_node.list[1]);
+            const bool right_unsigned = context.is_unsigned(ast_node.list[2]);
+            const bool is_unsigned = context.to_common_type(left, left_unsigned, right, right_unsigned);
 
             llvm::Value* comparison_result = nullptr;
 
-            if (left_int && right_int) {
+            if (is_integer_type(left)) {
                 if (op == ">") {
-                    comparison_result = context.m_BUILDER.CreateICmpSGT(left, right);
+                    comparison_result = is_unsigned ? context.m_BUILDER.CreateICmpUGT(left, right)
+                                                    : context.m_BUILDER.CreateICmpSGT(left, right);
                 } else if (op == "<") {
-                    comparison_result = context.m_BUILDER.CreateICmpSLT(left, right);
+                    comparison_result = is_unsigned ? context.m_BUILDER.CreateICmpULT(left, right)
+                                                    : context.m_BUILDER.CreateICmpSLT(left, right);
                 } else if (op == ">=") {
-                    comparison_result = context.m_BUILDER.CreateICmpSGE(left, right);
+                    comparison_result = is_unsigned ? context.m_BUILDER.CreateICmpUGE(left, right)
+                                                    : context.m_BUILDER.CreateICmpSGE(left, right);
                 } else if (op == "<=") {
-                    comparison_result = context.m_BUILDER.CreateICmpSLE(left, right);
+                    comparison_result = is_unsigned ? context.m_BUILDER.CreateICmpULE(left, right)
+                                                    : context.m_BUILDER.CreateICmpSLE(left, right);
                 } else if (op == "==") {
                     comparison_result = context.m_BUILDER.CreateICmpEQ(left, right);
                 } else if (op == "!=") {
                     comparison_result = context.m_BUILDER.CreateICmpNE(left, right);
                 }
             } else {
-                llvm::Value* left_fp = promote_to_double(left, context);
-                llvm::Value* right_fp = promote_to_double(right, context);
-
                 if (op == ">") {
-                    comparison_result = context.m_BUILDER.CreateFCmpOGT(left_fp, right_fp);
+                    comparison_result = context.m_BUILDER.CreateFCmpOGT(left, right);
                 } else if (op == "<") {
-                    comparison_result = context.m_BUILDER.CreateFCmpOLT(left_fp, right_fp);
+                    comparison_result = context.m_BUILDER.CreateFCmpOLT(left, right);
                 } else if (op == ">=") {
-                    comparison_result = context.m_BUILDER.CreateFCmpOGE(left_fp, right_fp);
+                    comparison_result = context.m_BUILDER.CreateFCmpOGE(left, right);
                 } else if (op == "<=") {
-                    comparison_result = context.m_BUILDER.CreateFCmpOLE(left_fp, right_fp);
+                    comparison_result = context.m_BUILDER.CreateFCmpOLE(left, right);
                 } else if (op == "==") {
-                    comparison_result = context.m_BUILDER.CreateFCmpOEQ(left_fp, right_fp);
+                    comparison_result = context.m_BUILDER.CreateFCmpOEQ(left, right);
                 } else if (op == "!=") {
-                    comparison_result = context.m_BUILDER.CreateFCmpONE(left_fp, right_fp);
+                    comparison_result = context.m_BUILDER.CreateFCmpONE(left, right);
                 }
             }
 
@@ -27,7 +27,8 @@ namespace galluz::generators {
             }
 
             const std::string& keyword = first.string;
-            return keyword == "if" || keyword == "while" || keyword == "break" || keyword == "continue";
+            return keyword == "if" || keyword == "cond" || keyword == "match" || keyword == "while"
+                || keyword == "for" || keyword == "break" || keyword == "continue";
         }
 
         auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
@@ -35,8 +36,14 @@ namespace galluz::generators {
 
             if (keyword == "if") {
                 return generate_if(ast_node, context);
+            } else if (keyword == "cond") {
+                return generate_cond(ast_node, context);
+            } else if (keyword == "match") {
+                return generate_match(ast_node, context);
             } else if (keyword == "while") {
                 return generate_while(ast_node, context);
+            } else if (keyword == "for") {
+                return generate_for(ast_node, context);
             } else if (keyword == "break") {
                 return generate_break(context);
             } else if (keyword == "continue") {
@@ -47,6 +54,94 @@ namespace galluz::generators {
         }
 
       private:
+        /// A value that reaches the merge block of a branching form, and the block it comes from
+        struct Branch {
+            llvm::Value* value;
+            llvm::BasicBlock* block;
+            bool is_unsigned = false;
+        };
+        using Incoming = std::vector<Branch>;
+
+        static auto is_mergeable_scalar(llvm::Type* type) -> bool {
+            return (type->isIntegerTy() && !type->isIntegerTy(1)) || type->isFloatingPointTy();
+        }
+
+        static auto to_condition(llvm::Value* value, core::CompilationContext& context) -> llvm::Value* {
+            if (value->getType()->isIntegerTy(1)) {
+                return value;
+            }
+            return context.m_BUILDER.CreateICmpNE(value, llvm::ConstantInt::get(value->getType(), 0));
+        }
+
+        /**
+         * @brief Continue in @p merge_block with the value of whichever branch reached it
+         *
+         * @p incoming holds the value of every branch that falls through to the merge and the block
+         * it arrives from; a null value (an omitted else) becomes zero. Numbers of different types
+         * meet in their common type, converted at the end of each branch; branches of otherwise
+         * different types make the form a statement, whose value is 0.
+         */
+        static auto merge_branches(Incoming& incoming,
+                                   llvm::BasicBlock* merge_block,
+                                   const char* name,
+                                   core::CompilationContext& context) -> llvm::Value* {
+            context.m_BUILDER.SetInsertPoint(merge_block);
+
+            if (incoming.empty()) {
+                context.m_BUILDER.CreateUnreachable();
+                return llvm::UndefValue::get(context.m_BUILDER.getInt32Ty());
+            }
+
+            llvm::Type* result_type = nullptr;
+            bool result_unsigned = false;
+            for (const auto& branch : incoming) {
+                if (!branch.value) {
+                    continue;
+                }
+                llvm::Type* type = branch.value->getType();
+                if (!result_type) {
+                    result_type = type;
+                    result_unsigned = branch.is_unsigned;
+                } else if (type != result_type) {
+                    if (!is_mergeable_scalar(type) || !is_mergeable_scalar(result_type)) {
+                        return context.m_BUILDER.getInt32(0);
+                    }
+                    llvm::Type* merged =
+                        context.common_type(result_type, result_unsigned, type, branch.is_unsigned);
+                    if (merged->isIntegerTy() && result_type->isIntegerTy() && type->isIntegerTy()) {
+                        result_unsigned = core::CompilationContext::common_unsigned(
+                            result_type->getIntegerBitWidth(),
+                            result_unsigned,
+                            type->getIntegerBitWidth(),
+                            branch.is_unsigned);
+                    }
+                    result_type = merged;
+                }
+            }
+
+            if (!result_type || result_type->isVoidTy()) {
+                return context.m_BUILDER.getInt32(0);
+            }
+
+            for (auto& branch : incoming) {
+                if (branch.value && branch.value->getType() != result_type) {
+                    context.m_BUILDER.SetInsertPoint(branch.block->getTerminator());
+                    branch.value =
+                        context.convert_scalar(branch.value, branch.is_unsigned, result_type, false);
+                }
+            }
+            context.m_BUILDER.SetInsertPoint(merge_block);
+
+            llvm::PHINode* phi =
+                context.m_BUILDER.CreatePHI(result_type, static_cast<unsigned>(incoming.size()), name);
+            for (const auto& branch : incoming) {
+                phi->addIncoming(branch.value ? branch.value : llvm::Constant::getNullValue(result_type),
+                                 branch.block);
+            }
+
+            return phi;
+        }
+
         auto generate_if(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
             if (ast_node.list.size() < 3) {
                 LOG_CRITICAL("if statement requires condition and then-branch");
@@ -54,13 +149,10 @@ namespace galluz::generators {
 
             llvm::Function* current_func = context.m_CURRENT_FUNCTION;
 
-            llvm::Value* cond_value = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
-
-            if (!cond_value->getType()->isIntegerTy(1)) {
-                cond_value = context.m_BUILDER.CreateICmpNE(cond_value,
-                                                            llvm::ConstantInt::get(cond_value->getType(), 0));
-            }
+            llvm::Value* cond_value =
+                to_condition(m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context), context);
 
+            llvm::BasicBlock* cond_end = context.m_BUILDER.GetInsertBlock();
             llvm::BasicBlock* then_block = llvm::BasicBlock::Create(context.m_CTX, "if.then", current_func);
             llvm::BasicBlock* else_block = nullptr;
             llvm::BasicBlock* merge_block = llvm::BasicBlock::Create(context.m_CTX, "if.end", current_func);
@@ -74,100 +166,529 @@ namespace galluz::generators {
                 context.m_BUILDER.CreateCondBr(cond_value, then_block, merge_block);
             }
 
+            // Values that reach the merge block, with the block they arrive from. A branch that
+            // already ended in break/continue/tail call/ret does not flow into the merge.
+            Incoming incoming;
+
             context.m_BUILDER.SetInsertPoint(then_block);
             context.push_scope();
             llvm::Value* then_result = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
             context.pop_scope();
 
             if (!context.m_BUILDER.GetInsertBlock()->getTerminator()) {
+                incoming.push_back(
+                    {then_result, context.m_BUILDER.GetInsertBlock(), context.is_unsigned(ast_node.list[2])});
                 context.m_BUILDER.CreateBr(merge_block);
             }
 
-            llvm::BasicBlock* then_end = context.m_BUILDER.GetInsertBlock();
-
-            llvm::Value* else_result = nullptr;
-            llvm::BasicBlock* else_end = nullptr;
-
             if (has_else) {
                 context.m_BUILDER.SetInsertPoint(else_block);
                 context.push_scope();
-                else_result = m_GENERATOR_MANAGER->generate_code(ast_node.list[3], context);
+                llvm::Value* else_result = m_GENERATOR_MANAGER->generate_code(ast_node.list[3], context);
                 context.pop_scope();
 
                 if (!context.m_BUILDER.GetInsertBlock()->getTerminator()) {
+                    incoming.push_back({else_result,
+                                        context.m_BUILDER.GetInsertBlock(),
+                                        context.is_unsigned(ast_node.list[3])});
                     context.m_BUILDER.CreateBr(merge_block);
                 }
+            } else {
+                incoming.push_back({nullptr, cond_end});
+            }
 
-                else_end = context.m_BUILDER.GetInsertBlock();
+            return merge_branches(incoming, merge_block, "if.result", context);
+        }
+
+        /**
+         * @brief (cond (test body) ... [(else body)])
+         *
+         * The tests are tried in order and the first that holds selects its body; all bodies join
+         * in one merge block.
+         */
+        auto generate_cond(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() < 2) {
+                LOG_CRITICAL("cond requires at least one (test body) clause");
             }
 
-            context.m_BUILDER.SetInsertPoint(merge_block);
+            llvm::Function* current_func = context.m_CURRENT_FUNCTION;
+            llvm::BasicBlock* merge_block = llvm::BasicBlock::Create(context.m_CTX, "cond.end", current_func);
 
-            if (then_result) {
-                llvm::Type* result_type = then_result->getType();
-                llvm::PHINode* phi = context.m_BUILDER.CreatePHI(result_type, has_else ? 2 : 2, "if.result");
+            Incoming incoming;
+            bool has_else = false;
 
-                phi->addIncoming(then_result, then_end);
+            for (size_t i = 1; i < ast_node.list.size(); ++i) {
+                const auto& clause = ast_node.list[i];
+                if (clause.type != ExpType::LIST || clause.list.size() != 2) {
+                    LOG_CRITICAL("Invalid cond clause: (test body) or (else body)");
+                }
+
+                has_else = clause.list[0].type == ExpType::SYMBOL && clause.list[0].string == "else";
+                if (has_else && i != ast_node.list.size() - 1) {
+                    LOG_CRITICAL("else must be the last clause of cond");
+                }
+
+                llvm::BasicBlock* next_block = nullptr;
+                if (!has_else) {
+                    llvm::Value* test =
+                        to_condition(m_GENERATOR_MANAGER->generate_code(clause.list[0], context), context);
+                    llvm::BasicBlock* body_block =
+                        llvm::BasicBlock::Create(context.m_CTX, "cond.then", current_func);
+                    next_block = llvm::BasicBlock::Create(context.m_CTX, "cond.next", current_func);
+                    context.m_BUILDER.CreateCondBr(test, body_block, next_block);
+                    context.m_BUILDER.SetInsertPoint(body_block);
+                }
 
-                if (has_else && else_result) {
-                    phi->addIncoming(else_result, else_end);
-                } else if (has_else) {
-                    phi->addIncoming(llvm::Constant::getNullValue(result_type), else_end);
+                context.push_scope();
+                llvm::Value* result = m_GENERATOR_MANAGER->generate_code(clause.list[1], context);
+                context.pop_scope();
+
+                if (!context.m_BUILDER.GetInsertBlock()->getTerminator()) {
+                    incoming.push_back(
+                        {result, context.m_BUILDER.GetInsertBlock(), context.is_unsigned(clause.list[1])});
+                    context.m_BUILDER.CreateBr(merge_block);
+                }
+
+                if (next_block) {
+                    context.m_BUILDER.SetInsertPoint(next_block);
+                }
+            }
+
+            if (!has_else) {
+                incoming.push_back({nullptr, context.m_BUILDER.GetInsertBlock()});
+                context.m_BUILDER.CreateBr(merge_block);
+            }
+
+            return merge_branches(incoming, merge_block, "cond.result", context);
+        }
+
+        /**
+         * @brief A match label as a case value of @p type: an integer literal, true or false
+         */
+        static auto match_constant(const Exp& label, llvm::IntegerType* type) -> llvm::ConstantInt* {
+            if (label.type == ExpType::NUMBER) {
+                const bool fits = label.number >= 0
+                    ? llvm::ConstantInt::isValueValidForType(type, static_cast<uint64_t>(label.number))
+                    : llvm::ConstantInt::isValueValidForType(type, static_cast<int64_t>(label.number));
+                if (label.out_of_range || !fits) {
+                    LOG_CRITICAL("match label %s does not fit the matched type", label.string);
+                }
+                return llvm::ConstantInt::get(type, static_cast<uint64_t>(label.number), true);
+            }
+            if (label.type == ExpType::SYMBOL && (label.string == "true" || label.string == "false")) {
+                return llvm::ConstantInt::get(type, label.string == "true" ? 1 : 0);
+            }
+            LOG_CRITICAL("match labels must be integer literals, true or false");
+            return nullptr;
+        }
+
+        /**
+         * @brief (match value (label body) ((label ...) body) ... [(else body)])
+         *
+         * Lowered to a single switch on the value, which the backend turns into a jump table, a
+         * bit test or a binary search depending on the density of the labels.
+         */
+        auto generate_match(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() < 3) {
+                LOG_CRITICAL("match requires a value and at least one (label body) clause");
+            }
+
+            llvm::Value* value = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
+            auto* value_type = llvm::dyn_cast<llvm::IntegerType>(value->getType());
+            if (!value_type) {
+                LOG_CRITICAL("match value must be an integer or a bool");
+            }
+
+            llvm::Function* current_func = context.m_CURRENT_FUNCTION;
+            llvm::BasicBlock* merge_block =
+                llvm::BasicBlock::Create(context.m_CTX, "match.end", current_func);
+
+            llvm::BasicBlock* switch_block = context.m_BUILDER.GetInsertBlock();
+            llvm::SwitchInst* switch_inst = context.m_BUILDER.CreateSwitch(
+                value, merge_block, static_cast<unsigned>(ast_node.list.size() - 2));
+
+            Incoming incoming;
+
+            for (size_t i = 2; i < ast_node.list.size(); ++i) {
+                const auto& clause = ast_node.list[i];
+                if (clause.type != ExpType::LIST || clause.list.size() != 2) {
+                    LOG_CRITICAL("Invalid match clause: (label body), ((label ...) body) or (else body)");
+                }
+
+                const auto& label = clause.list[0];
+                const bool is_else = label.type == ExpType::SYMBOL && label.string == "else";
+                if (is_else && i != ast_node.list.size() - 1) {
+                    LOG_CRITICAL("else must be the last clause of match");
+                }
+
+                llvm::BasicBlock* body_block = llvm::BasicBlock::Create(
+                    context.m_CTX, is_else ? "match.else" : "match.case", current_func);
+
+                if (is_else) {
+                    switch_inst->setDefaultDest(body_block);
                 } else {
-                    phi->addIncoming(llvm::Constant::getNullValue(result_type), then_end);
+                    std::vector<const Exp*> labels;
+                    if (label.type == ExpType::LIST) {
+                        for (const auto& item : label.list) {
+                            labels.push_back(&item);
+                        }
+                    } else {
+                        labels.push_back(&label);
+                    }
+                    if (labels.empty()) {
+                        LOG_CRITICAL("match clause needs at least one label");
+                    }
+
+                    for (const auto* item : labels) {
+                        llvm::ConstantInt* case_value = match_constant(*item, value_type);
+                        if (switch_inst->findCaseValue(case_value) != switch_inst->case_default()) {
+                            LOG_CRITICAL("Duplicate match label %s",
+                                         std::to_string(case_value->getSExtValue()));
+                        }
+                        switch_inst->addCase(case_value, body_block);
+                    }
                 }
 
-                return phi;
+                context.m_BUILDER.SetInsertPoint(body_block);
+                context.push_scope();
+                llvm::Value* result = m_GENERATOR_MANAGER->generate_code(clause.list[1], context);
+                context.pop_scope();
+
+                if (!context.m_BUILDER.GetInsertBlock()->getTerminator()) {
+                    incoming.push_back(
+                        {result, context.m_BUILDER.GetInsertBlock(), context.is_unsigned(clause.list[1])});
+                    context.m_BUILDER.CreateBr(merge_block);
+                }
             }
 
-            return context.m_BUILDER.getInt32(0);
+            if (switch_inst->getDefaultDest() == merge_block) {
+                incoming.push_back({nullptr, switch_block});
+            }
+
+            return merge_branches(incoming, merge_block, "match.result", context);
+        }
+
+        /**
+         * @brief Optional tuning of one loop, the counterpart of `#pragma clang loop`
+         */
+        struct LoopHints {
+            unsigned unroll = 0;
+            unsigned vectorize_width = 0;
+            unsigned interleave = 0;
+            bool no_vectorize = false;
+            bool distribute = false;
+
+            auto empty() const -> bool {
+                return unroll == 0 && vectorize_width == 0 && interleave == 0 && !no_vectorize && !distribute;
+            }
+        };
+
+        /**
+         * @brief Read the hints between a loop's header (ending at @p first) and its body
+         *
+         * :unroll N, :vectorize-width N, :interleave N, :no-vectorize, :distribute
+         */
+        static auto parse_loop_hints(const Exp& ast_node, size_t first) -> LoopHints {
+            LoopHints hints;
+            const size_t body_index = ast_node.list.size() - 1;
+
+            for (size_t i = first; i < body_index; ++i) {
+                const auto& hint = ast_node.list[i];
+                if (hint.type != ExpType::SYMBOL || hint.string.empty() || hint.string[0] != ':') {
+                    LOG_CRITICAL("Expected a loop hint such as :unroll 4 before the loop body");
+                }
+
+                const std::string& name = hint.string;
+                if (name == ":no-vectorize") {
+                    hints.no_vectorize = true;
+                    continue;
+                }
+                if (name == ":distribute") {
+                    hints.distribute = true;
+                    continue;
+                }
+
+                unsigned* count = nullptr;
+                if (name == ":unroll") {
+                    count = &hints.unroll;
+                } else if (name == ":vectorize-width") {
+                    count = &hints.vectorize_width;
+                } else if (name == ":interleave") {
+                    count = &hints.interleave;
+                } else {
+                    LOG_CRITICAL("Unknown loop hint %s", name);
+                }
+
+                if (i + 1 >= body_index || ast_node.list[i + 1].type != ExpType::NUMBER
+                    || ast_node.list[i + 1].number < 1)
+                {
+                    LOG_CRITICAL("Loop hint %s needs a positive integer literal", name);
+                }
+                *count = static_cast<unsigned>(ast_node.list[++i].number);
+            }
+
+            if (hints.no_vectorize && hints.vectorize_width > 1) {
+                LOG_CRITICAL("Loop hints :no-vectorize and :vectorize-width conflict");
+            }
+            return hints;
         }
 
+        /**
+         * @brief Attach @p hints to the loop's only back edge as its llvm.loop metadata
+         *
+         * A hint the optimizer cannot honor is reported as a warning (see LoopRemarkHandler).
+         */
+        static auto attach_loop_hints(llvm::Instruction* latch_branch,
+                                      const LoopHints& hints,
+                                      llvm::LLVMContext& llvm_context) -> void {
+            if (hints.empty()) {
+                return;
+            }
+
+            // Operand 0 is the node itself, which makes it a loop ID
+            std::vector<llvm::Metadata*> operands = {nullptr};
+            const auto add = [&](const char* name, llvm::Metadata* value)
+            {
+                std::vector<llvm::Metadata*> property = {llvm::MDString::get(llvm_context, name)};
+                if (value) {
+                    property.push_back(value);
+                }
+                operands.push_back(llvm::MDNode::get(llvm_context, property));
+            };
+            const auto count = [&](unsigned value) -> llvm::Metadata*
+            {
+                return llvm::ConstantAsMetadata::get(
+                    llvm::ConstantInt::get(llvm::Type::getInt32Ty(llvm_context), value));
+            };
+            llvm::Metadata* enable = llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(llvm_context));
+
+            if (hints.unroll == 1) {
+                add("llvm.loop.unroll.disable", nullptr);
+            } else if (hints.unroll > 1) {
+                add("llvm.loop.unroll.count", count(hints.unroll));
+            }
+
+            if (hints.no_vectorize) {
+                // Width 1 still allows interleaving; with an interleave count of 1 too it disables both
+                add("llvm.loop.vectorize.width", count(1));
+                if (hints.interleave == 0) {
+                    add("llvm.loop.interleave.count", count(1));
+                }
+            } else if (hints.vectorize_width > 0) {
+                add("llvm.loop.vectorize.width", count(hints.vectorize_width));
+                if (hints.vectorize_width > 1) {
+                    add("llvm.loop.vectorize.enable", enable);
+                }
+            }
+            if (hints.interleave > 0) {
+                add("llvm.loop.interleave.count", count(hints.interleave));
+            }
+
+            if (hints.distribute) {
+                add("llvm.loop.distribute.enable", enable);
+            }
+
+            auto* loop_id = llvm::MDNode::getDistinct(llvm_context, operands);
+            loop_id->replaceOperandWith(0, loop_id);
+            latch_branch->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+        }
+
+        /**
+         * @brief (while condition [hints] body)
+         *
+         * The body and `continue` branch to a single latch, which carries the loop hints.
+         */
         auto generate_while(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
-            if (ast_node.list.size() != 3) {
+            if (ast_node.list.size() < 3) {
                 LOG_CRITICAL("while statement requires condition and body");
             }
 
+            const LoopHints hints = parse_loop_hints(ast_node, 2);
             llvm::Function* current_func = context.m_CURRENT_FUNCTION;
 
             llvm::BasicBlock* cond_block =
                 llvm::BasicBlock::Create(context.m_CTX, "while.cond", current_func);
             llvm::BasicBlock* body_block =
                 llvm::BasicBlock::Create(context.m_CTX, "while.body", current_func);
+            llvm::BasicBlock* latch_block =
+                llvm::BasicBlock::Create(context.m_CTX, "while.latch", current_func);
             llvm::BasicBlock* exit_block = llvm::BasicBlock::Create(context.m_CTX, "while.end", current_func);
 
             context.m_BUILDER.CreateBr(cond_block);
 
             context.m_BUILDER.SetInsertPoint(cond_block);
-            llvm::Value* cond_value = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
-
-            if (!cond_value->getType()->isIntegerTy(1)) {
-                cond_value = context.m_BUILDER.CreateICmpNE(cond_value,
-                                                            llvm::ConstantInt::get(cond_value->getType(), 0));
-            }
+            llvm::Value* cond_value =
+                to_condition(m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context), context);
 
             context.m_BUILDER.CreateCondBr(cond_value, body_block, exit_block);
 
             context.m_BUILDER.SetInsertPoint(body_block);
 
-            core::LoopContext loop_ctx = {cond_block, body_block, cond_block, exit_block};
+            core::LoopContext loop_ctx = {cond_block, body_block, latch_block, exit_block};
             context.push_loop(loop_ctx);
             context.push_scope();
 
-            m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
+            m_GENERATOR_MANAGER->generate_code(ast_node.list.back(), context);
 
             context.pop_scope();
             context.pop_loop();
 
             if (!context.m_BUILDER.GetInsertBlock()->getTerminator()) {
-                context.m_BUILDER.CreateBr(cond_block);
+                context.m_BUILDER.CreateBr(latch_block);
             }
 
+            context.m_BUILDER.SetInsertPoint(latch_block);
+            attach_loop_hints(context.m_BUILDER.CreateBr(cond_block), hints, context.m_CTX);
+
             context.m_BUILDER.SetInsertPoint(exit_block);
 
             return context.m_BUILDER.getInt32(0);
         }
 
+        /**
+         * @brief Whether the latch increment provably stays within the counter's type
+         *
+         * The last index the condition lets through is end - 1 counting up and end + 1 counting
+         * down. A step of 1 or -1 therefore never leaves the type; a larger one only when @p end
+         * is a constant at least |step| - 1 away from the type's limit. Otherwise the counter
+         * wraps and the increment must not carry nsw/nuw.
+         */
+        static auto step_stays_in_range(llvm::Value* end, int64_t step, bool is_unsigned) -> bool {
+            if (step == 1 || step == -1) {
+                return true;
+            }
+            auto* bound = llvm::dyn_cast<llvm::ConstantInt>(end);
+            if (!bound) {
+                return false;
+            }
+            const uint64_t magnitude = step < 0 ? 0 - static_cast<uint64_t>(step)
+                                                : static_cast<uint64_t>(step);
+            const unsigned bits = bound->getBitWidth();
+            if (bits < 64 && ((magnitude - 1) >> bits) != 0) {
+                return false;
+            }
+            const llvm::APInt room(bits, magnitude - 1);
+            bool overflow = false;
+            if (step > 0) {
+                (void)(is_unsigned ? bound->getValue().uadd_ov(room, overflow)
+                                   : bound->getValue().sadd_ov(room, overflow));
+            } else {
+                (void)(is_unsigned ? bound->getValue().usub_ov(room, overflow)
+                                   : bound->getValue().ssub_ov(room, overflow));
+            }
+            return !overflow;
+        }
+
+        /**
+         * @brief Counted loop: (for (i start end [step]) [hints] body)
+         *
+         * Emitted directly in the canonical form the loop passes look for: a preheader that
+         * evaluates the bounds once, a header with the induction variable as a PHI, a single
+         * latch with a no-wrap increment and a dedicated exit. `continue` jumps to the latch.
+         * The variable counts up to `end` (exclusive) for a positive step and down to it for a
+         * negative one; it is read-only inside the body. It has the type of the wider bound, and
+         * at least 32 bits, so that (for (i 0 n) ...) with an i64 n counts in 64 bits.
+         */
+        auto generate_for(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() < 3 || ast_node.list[1].type != ExpType::LIST
+                || ast_node.list[1].list.size() < 3 || ast_node.list[1].list.size() > 4
+                || ast_node.list[1].list[0].type != ExpType::SYMBOL)
+            {
+                LOG_CRITICAL("for statement requires (variable start end [step]) and body");
+            }
+
+            const auto& header = ast_node.list[1].list;
+            const std::string& var_name = header[0].string;
+            const LoopHints hints = parse_loop_hints(ast_node, 2);
+
+            int64_t step = 1;
+            if (header.size() == 4) {
+                if (header[3].type != ExpType::NUMBER || header[3].number == 0) {
+                    LOG_CRITICAL("for step must be a non-zero integer literal");
+                }
+                step = header[3].number;
+            }
+
+            llvm::Function* current_func = context.m_CURRENT_FUNCTION;
+            auto& builder = context.m_BUILDER;
+
+            llvm::Value* start = m_GENERATOR_MANAGER->generate_code(header[1], context);
+            llvm::Value* end = m_GENERATOR_MANAGER->generate_code(header[2], context);
+            if (!start->getType()->isIntegerTy() || !end->getType()->isIntegerTy()
+                || start->getType()->isIntegerTy(1))
+            {
+                LOG_CRITICAL("for bounds must be integers");
+            }
+            const bool start_unsigned = context.is_unsigned(header[1]);
+            const bool end_unsigned = context.is_unsigned(header[2]);
+            const bool is_unsigned = context.to_common_type(start, start_unsigned, end, end_unsigned);
+            if (start->getType()->getIntegerBitWidth() < 32) {
+                start = builder.CreateIntCast(start, builder.getInt32Ty(), !is_unsigned);
+                end = builder.CreateIntCast(end, builder.getInt32Ty(), !is_unsigned);
+            }
+            llvm::Type* index_type = start->getType();
+            auto* index_type_info = context.type_system->get_integer_type(index_type, is_unsigned);
+
+            llvm::BasicBlock* preheader =
+                llvm::BasicBlock::Create(context.m_CTX, "for.preheader", current_func);
+            llvm::BasicBlock* cond_block = llvm::BasicBlock::Create(context.m_CTX, "for.cond", current_func);
+            llvm::BasicBlock* body_block = llvm::BasicBlock::Create(context.m_CTX, "for.body", current_func);
+            llvm::BasicBlock* latch_block =
+                llvm::BasicBlock::Create(context.m_CTX, "for.latch", current_func);
+            llvm::BasicBlock* exit_block = llvm::BasicBlock::Create(context.m_CTX, "for.end", current_func);
+
+            builder.CreateBr(preheader);
+            builder.SetInsertPoint(preheader);
+            builder.CreateBr(cond_block);
+
+            builder.SetInsertPoint(cond_block);
+            llvm::PHINode* index = builder.CreatePHI(index_type, 2, var_name);
+            index->addIncoming(start, preheader);
+            auto predicate = is_unsigned ? llvm::CmpInst::ICMP_ULT : llvm::CmpInst::ICMP_SLT;
+            if (step < 0) {
+                predicate = is_unsigned ? llvm::CmpInst::ICMP_UGT : llvm::CmpInst::ICMP_SGT;
+            }
+            llvm::Value* in_range = builder.CreateICmp(predicate, index, end);
+            builder.CreateCondBr(in_range, body_block, exit_block);
+
+            builder.SetInsertPoint(body_block);
+
+            core::LoopContext loop_ctx = {cond_block, body_block, latch_block, exit_block};
+            context.push_loop(loop_ctx);
+            context.push_scope();
+
+            context.add_variable(var_name, index, index_type, index_type_info);
+
+            m_GENERATOR_MANAGER->generate_code(ast_node.list.back(), context);
+
+            context.pop_scope();
+            context.pop_loop();
+
+            if (!builder.GetInsertBlock()->getTerminator()) {
+                builder.CreateBr(latch_block);
+            }
+
+            builder.SetInsertPoint(latch_block);
+            auto* step_value = llvm::ConstantInt::get(index_type, static_cast<uint64_t>(step), true);
+            // Counting an unsigned counter down adds the step's two's complement, which always wraps
+            // in the unsigned sense, so that case never carries a flag
+            llvm::Value* next = nullptr;
+            const bool no_wrap = step_stays_in_range(end, step, is_unsigned);
+            if (no_wrap && !is_unsigned) {
+                next = builder.CreateNSWAdd(index, step_value, var_name + ".next");
+            } else if (no_wrap && step > 0) {
+                next = builder.CreateNUWAdd(index, step_value, var_name + ".next");
+            } else {
+                next = builder.CreateAdd(index, step_value, var_name + ".next");
+            }
+            attach_loop_hints(builder.CreateBr(cond_block), hints, context.m_CTX);
+            index->addIncoming(next, latch_block);
+
+            builder.SetInsertPoint(exit_block);
+
+            return builder.getInt32(0);
+        }
+
         auto generate_break(core::CompilationContext& context) -> llvm::Value* {
             auto* loop = context.get_current_loop();
             if (!loop) {
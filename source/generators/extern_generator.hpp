@@ -0,0 +1,121 @@
+#pragma once
+
+#include <llvm/IR/Function.h>
+
+#include "../core/types.hpp"
+#include "../logger.hpp"
+
+namespace galluz::generators {
+
+    /**
+     * @brief Declares a C function: (extern (name !ret) ((param !type) ...))
+     *
+     * The symbol is resolved by the linker (see --link-lib). Arguments follow the C ABI of the
+     * matching types: int is int32_t, str is a char pointer, bool is a zero-extended byte and a
+     * struct is passed as a pointer to it.
+     */
+    class ExternGenerator : public core::ICodeGenerator {
+      private:
+        static auto parse_type(const Exp& type_exp, core::CompilationContext& context) -> core::TypeInfo* {
+            if (type_exp.type != ExpType::SYMBOL || type_exp.string.empty() || type_exp.string[0] != '!') {
+                return nullptr;
+            }
+            return context.type_system->get_type(type_exp.string.substr(1));
+        }
+
+        static auto is_well_formed(const Exp& ast_node, core::CompilationContext& context) -> bool {
+            if (ast_node.list.size() != 3 || ast_node.list[1].type != ExpType::LIST
+                || ast_node.list[1].list.size() != 2 || ast_node.list[1].list[0].type != ExpType::SYMBOL
+                || !parse_type(ast_node.list[1].list[1], context) || ast_node.list[2].type != ExpType::LIST)
+            {
+                return false;
+            }
+
+            for (const auto& param : ast_node.list[2].list) {
+                if (param.type != ExpType::LIST || param.list.size() != 2
+                    || param.list[0].type != ExpType::SYMBOL || !parse_type(param.list[1], context))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+      public:
+        auto can_handle(const Exp& ast_node) const -> bool override {
+            return ast_node.type == ExpType::LIST && !ast_node.list.empty()
+                && ast_node.list[0].type == ExpType::SYMBOL && ast_node.list[0].string == "extern";
+        }
+
+        /**
+         * @brief Declare the function up front so that it can be called before the extern form
+         */
+        auto declare(const Exp& ast_node, core::CompilationContext& context, core::DeclarationPass pass)
+            -> void override {
+            if (pass == core::DeclarationPass::SIGNATURES && is_well_formed(ast_node, context)) {
+                generate(ast_node, context);
+            }
+        }
+
+        auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
+            if (!is_well_formed(ast_node, context)) {
+                LOG_CRITICAL("Invalid extern declaration: (extern (name !type) ((param !type) ...)) "
+                             "with known types");
+            }
+
+            const std::string func_name = ast_node.list[1].list[0].string;
+            core::TypeInfo* return_type = parse_type(ast_node.list[1].list[1], context);
+            if (return_type->kind == core::TypeKind::STRUCT) {
+                LOG_CRITICAL("Extern function %s cannot return a struct by value", func_name);
+            }
+
+            std::vector<llvm::Type*> param_types;
+            std::vector<core::VariableInfo> param_infos;
+            for (const auto& param : ast_node.list[2].list) {
+                core::TypeInfo* type = parse_type(param.list[1], context);
+                if (type->kind == core::TypeKind::VOID) {
+                    LOG_CRITICAL("Parameter %s of extern function %s cannot be void",
+                                 param.list[0].string,
+                                 func_name);
+                }
+
+                llvm::Type* param_type = type->llvm_type;
+                if (type->kind == core::TypeKind::STRUCT) {
+                    param_type = param_type->getPointerTo();
+                }
+                param_types.push_back(param_type);
+                param_infos.push_back({nullptr, param_type, type, false, param.list[0].string});
+            }
+
+            auto* func_type = llvm::FunctionType::get(return_type->llvm_type, param_types, false);
+            auto* func = context.m_MODULE.getFunction(func_name);
+            if (func && func->getFunctionType() != func_type) {
+                LOG_CRITICAL("Extern function %s conflicts with an existing declaration", func_name);
+            }
+            if (func && !func->isDeclaration()) {
+                LOG_CRITICAL("Extern function %s is already defined in this program", func_name);
+            }
+            if (!func) {
+                func = llvm::Function::Create(
+                    func_type, llvm::Function::ExternalLinkage, func_name, &context.m_MODULE);
+            }
+
+            for (size_t i = 0; i < param_infos.size(); ++i) {
+                const auto extension = param_infos[i].type_info->extension_attribute();
+                if (extension != llvm::Attribute::None) {
+                    func->addParamAttr(static_cast<unsigned>(i), extension);
+                }
+            }
+            if (return_type->extension_attribute() != llvm::Attribute::None) {
+                func->addRetAttr(return_type->extension_attribute());
+            }
+
+            context.add_function(func_name, func, return_type, param_infos, true);
+
+            return context.m_BUILDER.getInt64(0);
+        }
+
+        auto get_priority() const -> int override { return 950; }
+    };
+
+}    // namespace galluz::generators
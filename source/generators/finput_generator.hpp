@@ -199,6 +199,9 @@ namespace galluz::generators {
                     if (!var_info) {
                         throw std::runtime_error("Variable not found for finput: " + arg_exp.string);
                     }
+                    if (llvm::isa<llvm::PHINode>(var_info->value)) {
+                        throw std::runtime_error("Cannot read into for loop variable: " + arg_exp.string);
+                    }
 
                     llvm::Value* storage_ptr = nullptr;
 
@@ -474,10 +477,25 @@ namespace galluz::generators {
             }
 
             switch (type_info->kind) {
-                case core::TypeKind::INT:
-                    return "%d";
+                case core::TypeKind::INT: {
+                    const char* length = "";
+                    switch (type_info->llvm_type->getIntegerBitWidth()) {
+                        case 8:
+                            length = "hh";
+                            break;
+                        case 16:
+                            length = "h";
+                            break;
+                        case 64:
+                            length = "ll";
+                            break;
+                        default:
+                            break;
+                    }
+                    return std::string("%") + length + (type_info->is_unsigned ? "u" : "d");
+                }
                 case core::TypeKind::DOUBLE:
-                    return "%lf";
+                    return type_info->llvm_type->isFloatTy() ? "%f" : "%lf";
                 case core::TypeKind::BOOL:
                     return "%d";
                 case core::TypeKind::STRING:
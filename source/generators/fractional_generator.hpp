@@ -6,6 +6,9 @@
 
 namespace galluz::generators {
 
+    /**
+     * @brief Floating point literals: 1.5 is a double, 1.5f32 a float
+     */
     class FractionalGenerator : public core::ICodeGenerator {
       public:
         auto can_handle(const Exp& ast_node) const -> bool override {
@@ -13,7 +16,9 @@ namespace galluz::generators {
         }
 
         auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
-            return llvm::ConstantFP::get(context.m_BUILDER.getDoubleTy(), ast_node.fractional);
+            auto* type =
+                ast_node.suffix == "f32" ? context.m_BUILDER.getFloatTy() : context.m_BUILDER.getDoubleTy();
+            return llvm::ConstantFP::get(type, ast_node.fractional);
         }
 
         auto get_priority() const -> int override { return 1000; }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Instructions.h>
+
 #include "../core/generator_manager.hpp"
 #include "../core/module_manager.hpp"
 #include "../core/types.hpp"
@@ -12,6 +17,67 @@ namespace galluz::generators {
         core::GeneratorManager* m_GENERATOR_MANAGER;
         core::ModuleManager* m_MODULE_MANAGER;
 
+        static auto uses_local_stack(const std::vector<llvm::Value*>& args) -> bool {
+            return std::any_of(args.begin(),
+                               args.end(),
+                               [](llvm::Value* arg)
+                               {
+                                   return arg->getType()->isPointerTy()
+                                       && llvm::isa<llvm::AllocaInst>(llvm::getUnderlyingObject(arg));
+                               });
+        }
+
+        /**
+         * @brief Emit the call, honouring tail position
+         *
+         * A self call in tail position of a defn with a `tailrecurse` block overwrites the parameter
+         * slots and loops. Any other tail call whose prototype matches the caller's is emitted as
+         * `musttail` followed by its `ret`; remaining tail calls get the `tail` hint. Calls that pass
+         * a pointer into the caller's frame are never marked, the callee must be able to use it.
+         * The callee's body is generated here if it is a deferred module function.
+         */
+        auto emit_call(llvm::Function* callee,
+                       const std::vector<llvm::Value*>& args,
+                       const Exp& ast_node,
+                       core::CompilationContext& context) -> llvm::Value* {
+            auto* caller = context.m_CURRENT_FUNCTION;
+
+            m_MODULE_MANAGER->materialize(callee, context);
+
+            if (!context.tail_positions.count(&ast_node) || uses_local_stack(args)) {
+                return context.m_BUILDER.CreateCall(callee, args);
+            }
+
+            if (callee == caller && context.tail_recurse_block) {
+                for (size_t i = 0; i < args.size(); ++i) {
+                    context.m_BUILDER.CreateStore(args[i], context.param_slots[i]);
+                }
+                context.m_BUILDER.CreateBr(context.tail_recurse_block);
+
+                if (callee->getReturnType()->isVoidTy()) {
+                    return context.m_BUILDER.getInt32(0);
+                }
+                return llvm::UndefValue::get(callee->getReturnType());
+            }
+
+            auto* call = context.m_BUILDER.CreateCall(callee, args);
+
+            if (callee->getFunctionType() != caller->getFunctionType()
+                || callee->getCallingConv() != caller->getCallingConv())
+            {
+                call->setTailCallKind(llvm::CallInst::TCK_Tail);
+                return call;
+            }
+
+            call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+            if (callee->getReturnType()->isVoidTy()) {
+                context.m_BUILDER.CreateRetVoid();
+            } else {
+                context.m_BUILDER.CreateRet(call);
+            }
+            return call;
+        }
+
         auto is_module_call(const Exp& ast_node) -> bool {
             if (ast_node.type != ExpType::LIST || ast_node.list.empty()) {
                 return false;
@@ -90,22 +156,14 @@ namespace galluz::generators {
                                          module_name.c_str(),
                                          func_name.c_str());
                         }
-                    } else if (param.type_info->kind == core::TypeKind::INT
-                               && arg_value->getType()->isIntegerTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateIntCast(arg_value, param.type, true);
-                    } else if (param.type_info->kind == core::TypeKind::DOUBLE
-                               && arg_value->getType()->isFloatingPointTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateFPCast(arg_value, param.type);
-                    } else if (param.type_info->kind == core::TypeKind::DOUBLE
-                               && arg_value->getType()->isIntegerTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateSIToFP(arg_value, param.type);
-                    } else if (param.type_info->kind == core::TypeKind::INT
-                               && arg_value->getType()->isFloatingPointTy())
+                    } else if (param.type_info->is_numeric()
+                               && (arg_value->getType()->isIntegerTy()
+                                   || arg_value->getType()->isFloatingPointTy()))
                     {
-                        arg_value = context.m_BUILDER.CreateFPToSI(arg_value, param.type);
+                        arg_value = context.convert_scalar(arg_value,
+                                                           context.is_unsigned(ast_node.list[i]),
+                                                           param.type,
+                                                           param.type_info->is_unsigned);
                     } else if (param.type_info->kind == core::TypeKind::BOOL
                                && arg_value->getType()->isIntegerTy())
                     {
@@ -120,7 +178,7 @@ namespace galluz::generators {
                 args.push_back(arg_value);
             }
 
-            return context.m_BUILDER.CreateCall(func_info->function, args);
+            return emit_call(func_info->function, args, ast_node, context);
         }
 
       public:
@@ -144,16 +202,22 @@ namespace galluz::generators {
             std::string name = first.string;
 
             std::unordered_set<std::string> reserved_keywords = {
-                "defn",    "var",     "global",    "set",      "scope",     "do",    "fprint",
-                "if",      "while",   "break",     "continue", "struct",    "new",   "getprop",
-                "setprop", "hasprop", "defmodule", "import",   "moduleuse", "finput"};
+                "defn",       "var",        "global",    "set",      "scope",     "do",      "fprint",
+                "if",         "while",      "break",     "continue", "struct",    "new",     "getprop",
+                "setprop",    "hasprop",    "defmodule", "import",   "moduleuse", "finput",  "extern",
+                "vec",        "splat",      "extract",   "insert",   "shuffle",   "select",  "reduce-add",
+                "reduce-min", "reduce-max", "sqrt",      "floor",    "ceil",      "exp",     "log",
+                "pow",        "copysign",   "fma",       "abs",      "min",       "max",     "popcount",
+                "clz",        "ctz",        "bswap",     "rotl",     "rotr",      "for",     "cond",
+                "match",      "and",        "or",        "not",      "cast",      "soa-vec", "soa-len",
+                "soa-get",    "soa-set",    "soa-free"};
 
             if (reserved_keywords.count(name)) {
                 return false;
             }
 
             std::unordered_set<std::string> operators = {
-                "+", "-", "*", "/", "%", ">", "<", ">=", "<=", "==", "!="};
+                "+", "-", "*", "/", "%", "<<", ">>", ">", "<", ">=", "<=", "==", "!="};
 
             if (operators.count(name)) {
                 return false;
@@ -200,22 +264,14 @@ namespace galluz::generators {
                         if (!arg_value->getType()->isPointerTy()) {
                             LOG_CRITICAL("Struct argument must be a pointer for function: %s", func_name);
                         }
-                    } else if (param.type_info->kind == core::TypeKind::INT
-                               && arg_value->getType()->isIntegerTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateIntCast(arg_value, param.type, true);
-                    } else if (param.type_info->kind == core::TypeKind::DOUBLE
-                               && arg_value->getType()->isFloatingPointTy())
+                    } else if (param.type_info->is_numeric()
+                               && (arg_value->getType()->isIntegerTy()
+                                   || arg_value->getType()->isFloatingPointTy()))
                     {
-                        arg_value = context.m_BUILDER.CreateFPCast(arg_value, param.type);
-                    } else if (param.type_info->kind == core::TypeKind::DOUBLE
-                               && arg_value->getType()->isIntegerTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateSIToFP(arg_value, param.type);
-                    } else if (param.type_info->kind == core::TypeKind::INT
-                               && arg_value->getType()->isFloatingPointTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateFPToSI(arg_value, param.type);
+                        arg_value = context.convert_scalar(arg_value,
+                                                           context.is_unsigned(ast_node.list[i]),
+                                                           param.type,
+                                                           param.type_info->is_unsigned);
                     } else if (param.type_info->kind == core::TypeKind::BOOL
                                && arg_value->getType()->isIntegerTy())
                     {
@@ -228,7 +284,7 @@ namespace galluz::generators {
                 args.push_back(arg_value);
             }
 
-            return context.m_BUILDER.CreateCall(func_info->function, args);
+            return emit_call(func_info->function, args, ast_node, context);
         }
 
       private:
@@ -269,22 +325,14 @@ namespace galluz::generators {
                         if (!arg_value->getType()->isPointerTy()) {
                             LOG_CRITICAL("Struct argument must be a pointer for function: %s", full_name);
                         }
-                    } else if (param.type_info->kind == core::TypeKind::INT
-                               && arg_value->getType()->isIntegerTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateIntCast(arg_value, param.type, true);
-                    } else if (param.type_info->kind == core::TypeKind::DOUBLE
-                               && arg_value->getType()->isFloatingPointTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateFPCast(arg_value, param.type);
-                    } else if (param.type_info->kind == core::TypeKind::DOUBLE
-                               && arg_value->getType()->isIntegerTy())
-                    {
-                        arg_value = context.m_BUILDER.CreateSIToFP(arg_value, param.type);
-                    } else if (param.type_info->kind == core::TypeKind::INT
-                               && arg_value->getType()->isFloatingPointTy())
+                    } else if (param.type_info->is_numeric()
+                               && (arg_value->getType()->isIntegerTy()
+                                   || arg_value->getType()->isFloatingPointTy()))
                     {
-                        arg_value = context.m_BUILDER.CreateFPToSI(arg_value, param.type);
+                        arg_value = context.convert_scalar(arg_value,
+                                                           context.is_unsigned(ast_node.list[i]),
+                                                           param.type,
+                                                           param.type_info->is_unsigned);
                     } else if (param.type_info->kind == core::TypeKind::BOOL
                                && arg_value->getType()->isIntegerTy())
                     {
@@ -297,7 +345,7 @@ namespace galluz::generators {
                 args.push_back(arg_value);
             }
 
-            return context.m_BUILDER.CreateCall(func_info->function, args);
+            return emit_call(func_info->function, args, ast_node, context);
         }
 
         auto get_priority() const -> int override { return 250; }
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <unordered_set>
+
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Verifier.h>
 
 #include "../core/generator_manager.hpp"
+#include "../core/type_inference.hpp"
 #include "../core/types.hpp"
 #include "../logger.hpp"
 
@@ -74,6 +78,11 @@ namespace galluz::generators {
                     if (!param.type) {
                         LOG_CRITICAL("Unknown parameter type: %s", param_type_exp.string);
                     }
+                    if (param.type->kind == core::TypeKind::UNKNOWN) {
+                        LOG_CRITICAL("Parameter %s needs a type; auto is only inferred for variables and "
+                                     "return types",
+                                     param.name);
+                    }
 
                     params.push_back(param);
                 } else {
@@ -84,11 +93,114 @@ namespace galluz::generators {
             return params;
         }
 
-        auto create_function_ir(const std::string& func_name,
-                                const std::vector<FunctionParam>& params,
-                                core::TypeInfo* return_type,
-                                const Exp& body,
-                                core::CompilationContext& context) -> llvm::Function* {
+        /**
+         * @brief Collect the expressions whose value is returned directly by the function
+         *
+         * The body itself is in tail position; `do`/`scope` pass it to their last form, an `if`
+         * with an else-branch passes it to both branches, and `cond` and `match` to the body of
+         * every clause, `else` included (their values only meet in the merge PHI).
+         */
+        static auto collect_tail_positions(const Exp& exp, std::unordered_set<const Exp*>& positions)
+            -> void {
+            positions.insert(&exp);
+
+            if (exp.type != ExpType::LIST || exp.list.empty() || exp.list[0].type != ExpType::SYMBOL) {
+                return;
+            }
+
+            const auto& head = exp.list[0].string;
+            if ((head == "do" || head == "scope") && exp.list.size() >= 2) {
+                collect_tail_positions(exp.list.back(), positions);
+            } else if (head == "if" && exp.list.size() >= 4) {
+                collect_tail_positions(exp.list[2], positions);
+                collect_tail_positions(exp.list[3], positions);
+            } else if (head == "cond" || head == "match") {
+                for (size_t i = head == "match" ? 2 : 1; i < exp.list.size(); ++i) {
+                    const auto& clause = exp.list[i];
+                    if (clause.type == ExpType::LIST && clause.list.size() == 2) {
+                        collect_tail_positions(clause.list[1], positions);
+                    }
+                }
+            }
+        }
+
+        static auto has_self_tail_call(const std::string& func_name,
+                                       const std::unordered_set<const Exp*>& positions) -> bool {
+            return std::any_of(positions.begin(),
+                               positions.end(),
+                               [&](const Exp* exp)
+                               {
+                                   return exp->type == ExpType::LIST && !exp->list.empty()
+                                       && exp->list[0].type == ExpType::SYMBOL
+                                       && exp->list[0].string == func_name;
+                               });
+        }
+
+        /**
+         * @brief Resolve the name and types of a defn without reporting errors
+         *
+         * An `!auto` return type is left as is for the caller to infer.
+         *
+         * @return false if the form is malformed or names a type that is not known yet
+         */
+        static auto resolve_signature(const Exp& ast_node,
+                                      core::CompilationContext& context,
+                                      std::string& func_name,
+                                      core::TypeInfo*& return_type,
+                                      std::vector<FunctionParam>& params) -> bool {
+            auto is_complete = [](const core::TypeInfo* type)
+            { return type && type->kind != core::TypeKind::UNKNOWN && type->llvm_type; };
+
+            if (ast_node.list.size() < 4 || ast_node.list[1].type != ExpType::LIST
+                || ast_node.list[1].list.size() != 2 || ast_node.list[1].list[0].type != ExpType::SYMBOL
+                || ast_node.list[1].list[1].type != ExpType::SYMBOL || ast_node.list[2].type != ExpType::LIST)
+            {
+                return false;
+            }
+
+            func_name = ast_node.list[1].list[0].string;
+            return_type = context.type_system->type_from_string(ast_node.list[1].list[1].string);
+            if (!return_type || (return_type->kind != core::TypeKind::UNKNOWN && !is_complete(return_type))) {
+                return false;
+            }
+
+            for (const auto& param_item : ast_node.list[2].list) {
+                if (param_item.type != ExpType::LIST || param_item.list.size() != 2
+                    || param_item.list[0].type != ExpType::SYMBOL
+                    || param_item.list[1].type != ExpType::SYMBOL)
+                {
+                    return false;
+                }
+
+                auto* type = context.type_system->type_from_string(param_item.list[1].string);
+                if (!is_complete(type) || type->kind == core::TypeKind::VOID) {
+                    return false;
+                }
+                params.push_back({param_item.list[0].string, type});
+            }
+
+            return true;
+        }
+
+        static auto make_param_infos(const std::vector<FunctionParam>& params)
+            -> std::vector<core::VariableInfo> {
+            std::vector<core::VariableInfo> param_infos;
+            for (const auto& param : params) {
+                llvm::Type* param_type = param.type->llvm_type;
+                if (param.type->kind == core::TypeKind::STRUCT) {
+                    param_type = param_type->getPointerTo();
+                }
+
+                core::VariableInfo var_info = {nullptr, param_type, param.type, false, param.name};
+                param_infos.push_back(var_info);
+            }
+            return param_infos;
+        }
+
+        static auto create_prototype(const std::string& func_name,
+                                     const std::vector<FunctionParam>& params,
+                                     core::TypeInfo* return_type,
+                                     core::CompilationContext& context) -> llvm::Function* {
             std::vector<llvm::Type*> param_types;
             for (const auto& param : params) {
                 if (param.type->kind == core::TypeKind::STRUCT) {
@@ -101,39 +213,89 @@ namespace galluz::generators {
             llvm::FunctionType* func_type =
                 llvm::FunctionType::get(return_type->llvm_type, param_types, false);
 
-            llvm::Function* func = llvm::Function::Create(
+            return llvm::Function::Create(
                 func_type, llvm::Function::ExternalLinkage, func_name, &context.m_MODULE);
+        }
+
+        /**
+         * @brief The prototype the declaration pass created for this defn in the current scope, if any
+         */
+        static auto find_declared_prototype(const std::string& func_name,
+                                            const std::vector<FunctionParam>& params,
+                                            core::TypeInfo* return_type,
+                                            core::CompilationContext& context) -> llvm::Function* {
+            auto& functions = context.current_scope->functions;
+            auto it = functions.find(func_name);
+            if (it == functions.end() || !context.pending_prototypes.count(it->second.function)
+                || it->second.return_type != return_type || it->second.parameters.size() != params.size())
+            {
+                return nullptr;
+            }
+
+            for (size_t i = 0; i < params.size(); ++i) {
+                if (it->second.parameters[i].type_info != params[i].type) {
+                    return nullptr;
+                }
+            }
+
+            context.pending_prototypes.erase(it->second.function);
+            return it->second.function;
+        }
+
+        auto create_function_ir(const std::string& func_name,
+                                const std::vector<FunctionParam>& params,
+                                core::TypeInfo* return_type,
+                                const Exp& body,
+                                core::CompilationContext& context) -> llvm::Function* {
+            llvm::Function* func = find_declared_prototype(func_name, params, return_type, context);
+            if (!func) {
+                func = create_prototype(func_name, params, return_type, context);
+            }
 
-            auto* old_insert_block = context.m_BUILDER.GetInsertBlock();
-            auto* old_func = context.m_CURRENT_FUNCTION;
+            auto caller = context.enter_function(func);
 
-            context.m_CURRENT_FUNCTION = func;
+            collect_tail_positions(body, context.tail_positions);
 
             llvm::BasicBlock* entry_block = llvm::BasicBlock::Create(context.m_CTX, "entry", func);
             context.m_BUILDER.SetInsertPoint(entry_block);
 
             context.push_scope();
 
+            // Scalar parameters live in stack slots so that `set` works on them and self tail calls
+            // can overwrite them; mem2reg turns the slots back into SSA values.
             size_t idx = 0;
+            bool has_struct_params = false;
             std::vector<core::VariableInfo> param_infos;
             for (auto& arg : func->args()) {
                 const auto& param = params[idx];
                 arg.setName(param.name);
 
                 if (param.type->kind == core::TypeKind::STRUCT) {
+                    has_struct_params = true;
                     core::VariableInfo var_info = {&arg, arg.getType(), param.type, false, param.name};
                     context.add_variable(param.name, &arg, arg.getType(), param.type, false);
                     param_infos.push_back(var_info);
                 } else {
+                    auto* slot = context.create_entry_alloca(param.type->llvm_type, param.name + ".addr");
+                    context.m_BUILDER.CreateStore(&arg, slot);
+                    context.param_slots.push_back(slot);
+
                     core::VariableInfo var_info = {
                         &arg, param.type->llvm_type, param.type, false, param.name};
-                    context.add_variable(param.name, &arg, param.type->llvm_type, param.type, false);
+                    context.add_variable(param.name, slot, param.type->llvm_type, param.type, false);
                     param_infos.push_back(var_info);
                 }
 
                 idx++;
             }
 
+            // Self tail calls become a branch back to this block instead of a new frame
+            if (!has_struct_params && has_self_tail_call(func_name, context.tail_positions)) {
+                context.tail_recurse_block = llvm::BasicBlock::Create(context.m_CTX, "tailrecurse", func);
+                context.m_BUILDER.CreateBr(context.tail_recurse_block);
+                context.m_BUILDER.SetInsertPoint(context.tail_recurse_block);
+            }
+
             context.add_function(func_name, func, return_type, param_infos, false);
 
             llvm::Value* result = m_GENERATOR_MANAGER->generate_code(body, context);
@@ -145,20 +307,13 @@ namespace galluz::generators {
             } else if (result) {
                 if (!context.m_BUILDER.GetInsertBlock()->getTerminator()) {
                     if (result->getType() != return_type->llvm_type) {
-                        if (return_type->kind == core::TypeKind::INT && result->getType()->isIntegerTy()) {
-                            result = context.m_BUILDER.CreateIntCast(result, return_type->llvm_type, true);
-                        } else if (return_type->kind == core::TypeKind::DOUBLE
-                                   && result->getType()->isFloatingPointTy())
+                        if (return_type->is_numeric()
+                            && (result->getType()->isIntegerTy() || result->getType()->isFloatingPointTy()))
                         {
-                            result = context.m_BUILDER.CreateFPCast(result, return_type->llvm_type);
-                        } else if (return_type->kind == core::TypeKind::DOUBLE
-                                   && result->getType()->isIntegerTy())
-                        {
-                            result = context.m_BUILDER.CreateSIToFP(result, return_type->llvm_type);
-                        } else if (return_type->kind == core::TypeKind::INT
-                                   && result->getType()->isFloatingPointTy())
-                        {
-                            result = context.m_BUILDER.CreateFPToSI(result, return_type->llvm_type);
+                            result = context.convert_scalar(result,
+                                                            context.is_unsigned(body),
+                                                            return_type->llvm_type,
+                                                            return_type->is_unsigned);
                         } else if (return_type->kind == core::TypeKind::BOOL
                                    && result->getType()->isIntegerTy())
                         {
@@ -175,11 +330,7 @@ namespace galluz::generators {
             }
 
             context.pop_scope();
-            context.m_CURRENT_FUNCTION = old_func;
-
-            if (old_insert_block) {
-                context.m_BUILDER.SetInsertPoint(old_insert_block);
-            }
+            context.leave_function(caller);
 
             llvm::verifyFunction(*func);
 
@@ -213,23 +364,57 @@ namespace galluz::generators {
 
             auto [func_name, return_type] = parse_typed_name(name_exp, context);
             auto params = parse_params(params_exp, context);
+            if (return_type->kind == core::TypeKind::UNKNOWN) {
+                core::TypeInference inference(context);
+                return_type = inference.infer_return_type(func_name, make_param_infos(params), body_exp);
+                if (!return_type && !inference.conflict().empty()) {
+                    LOG_CRITICAL("Cannot infer the return type of %s: %s", func_name, inference.conflict());
+                } else if (!return_type) {
+                    LOG_CRITICAL("Cannot infer the return type of %s; give it an explicit type", func_name);
+                }
+            }
 
             llvm::Function* func = create_function_ir(func_name, params, return_type, body_exp, context);
 
-            std::vector<core::VariableInfo> param_infos;
-            for (const auto& param : params) {
-                llvm::Type* param_type = param.type->llvm_type;
-                if (param.type->kind == core::TypeKind::STRUCT) {
-                    param_type = param_type->getPointerTo();
-                }
+            context.add_function(func_name, func, return_type, make_param_infos(params), false);
 
-                core::VariableInfo var_info = {nullptr, param_type, param.type, false, param.name};
-                param_infos.push_back(var_info);
+            return func;
+        }
+
+        /**
+         * @brief Make the defn callable from anywhere in its block, including earlier forms
+         */
+        auto declare(const Exp& ast_node, core::CompilationContext& context, core::DeclarationPass pass)
+            -> void override {
+            if (pass == core::DeclarationPass::TYPES) {
+                return;
             }
 
-            context.add_function(func_name, func, return_type, param_infos, false);
+            std::string func_name;
+            core::TypeInfo* return_type = nullptr;
+            std::vector<FunctionParam> params;
+            if (!resolve_signature(ast_node, context, func_name, return_type, params)
+                || context.current_scope->functions.count(func_name))
+            {
+                return;
+            }
 
-            return func;
+            // An auto return type can only be worked out once the explicit signatures are known
+            const bool inferred = return_type->kind == core::TypeKind::UNKNOWN;
+            if (inferred != (pass == core::DeclarationPass::INFERRED_SIGNATURES)) {
+                return;
+            }
+            if (inferred) {
+                return_type = core::TypeInference(context).infer_return_type(
+                    func_name, make_param_infos(params), ast_node.list[3]);
+                if (!return_type) {
+                    return;
+                }
+            }
+
+            auto* func = create_prototype(func_name, params, return_type, context);
+            context.pending_prototypes.insert(func);
+            context.add_function(func_name, func, return_type, make_param_infos(params), false);
         }
 
         auto get_priority() const -> int override { return 200; }
@@ -71,6 +71,8 @@ namespace galluz::generators {
 
             try {
                 m_MODULE_MANAGER->import_modules(file_path, modules_to_import, context, m_GENERATOR_MANAGER);
+            } catch (const CompileError&) {
+                throw;
             } catch (const std::exception& e) {
                 LOG_CRITICAL("Import failed: %s", e.what());
             }
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/Instructions.h>
+
+#include "../core/generator_manager.hpp"
+#include "../core/types.hpp"
+#include "../logger.hpp"
+
+namespace galluz::generators {
+
+    /**
+     * @brief Logical connectives: (and a b ...), (or a b ...), (not a)
+     *
+     * `and` and `or` short-circuit: an operand is only evaluated if the ones before it did not
+     * decide the result. When an operand is cheap and cannot trap or have side effects (arithmetic
+     * without division, comparisons, loads of variables), evaluating it anyway is unobservable, so
+     * it is computed unconditionally and combined with a select instead of a branch. Like
+     * comparisons, the result is 0 or 1; on mask vectors all three work lane by lane.
+     */
+    class LogicalGenerator : public core::ICodeGenerator {
+      private:
+        core::GeneratorManager* m_GENERATOR_MANAGER;
+
+        /// Beyond this many instructions, branching around an operand is cheaper than computing it
+        static const constexpr size_t MAX_SPECULATED_INSTRUCTIONS = 8;
+
+        static auto to_bool(llvm::Value* value, const std::string& op, core::CompilationContext& context)
+            -> llvm::Value* {
+            llvm::Type* type = value->getType();
+            if (type->isIntegerTy(1)) {
+                return value;
+            }
+            if (type->isIntegerTy()) {
+                return context.m_BUILDER.CreateICmpNE(value, llvm::ConstantInt::get(type, 0));
+            }
+            if (type->isFloatingPointTy()) {
+                return context.m_BUILDER.CreateFCmpUNE(value, llvm::ConstantFP::get(type, 0.0));
+            }
+            LOG_CRITICAL("Operands of %s must be integers, floating point numbers or bools", op);
+            return nullptr;
+        }
+
+        static auto is_mask(llvm::Value* value) -> bool {
+            auto* type = llvm::dyn_cast<llvm::VectorType>(value->getType());
+            return type && type->getElementType()->isIntegerTy(1);
+        }
+
+        /**
+         * @brief Whether @p block can run unconditionally: no side effects, no traps, and short
+         */
+        static auto is_speculatable(const llvm::BasicBlock* block) -> bool {
+            if (block->size() > MAX_SPECULATED_INSTRUCTIONS) {
+                return false;
+            }
+            for (const auto& inst : *block) {
+                if (!llvm::isSafeToSpeculativelyExecute(&inst)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Combine the lane masks of vector operands; there is nothing to short-circuit
+         */
+        auto generate_mask(const Exp& ast_node, llvm::Value* first, core::CompilationContext& context)
+            -> llvm::Value* {
+            const std::string& op = ast_node.list[0].string;
+
+            llvm::Value* result = first;
+            for (size_t i = 2; i < ast_node.list.size(); ++i) {
+                llvm::Value* operand = m_GENERATOR_MANAGER->generate_code(ast_node.list[i], context);
+                if (operand->getType() != result->getType()) {
+                    LOG_CRITICAL("Operands of %s must all be masks with the same number of lanes", op);
+                }
+                result = op == "and" ? context.m_BUILDER.CreateAnd(result, operand)
+                                     : context.m_BUILDER.CreateOr(result, operand);
+            }
+            return result;
+        }
+
+        /**
+         * @brief Fold one more operand into the i1 @p left of an and/or
+         */
+        auto generate_operand(const std::string& op,
+                              llvm::Value* left,
+                              const Exp& operand,
+                              core::CompilationContext& context) -> llvm::Value* {
+            auto& builder = context.m_BUILDER;
+            const bool is_and = op == "and";
+
+            llvm::BasicBlock* left_block = builder.GetInsertBlock();
+            llvm::BasicBlock* right_block = llvm::BasicBlock::Create(
+                context.m_CTX, is_and ? "and.rhs" : "or.rhs", context.m_CURRENT_FUNCTION);
+
+            builder.SetInsertPoint(right_block);
+            llvm::Value* right = to_bool(m_GENERATOR_MANAGER->generate_code(operand, context), op, context);
+            llvm::BasicBlock* right_end = builder.GetInsertBlock();
+
+            if (right_end == right_block && is_speculatable(right_block)) {
+                left_block->getInstList().splice(left_block->end(), right_block->getInstList());
+                right_block->eraseFromParent();
+                builder.SetInsertPoint(left_block);
+                return is_and ? builder.CreateLogicalAnd(left, right) : builder.CreateLogicalOr(left, right);
+            }
+
+            llvm::BasicBlock* merge_block = llvm::BasicBlock::Create(
+                context.m_CTX, is_and ? "and.end" : "or.end", context.m_CURRENT_FUNCTION);
+
+            builder.SetInsertPoint(left_block);
+            if (is_and) {
+                builder.CreateCondBr(left, right_block, merge_block);
+            } else {
+                builder.CreateCondBr(left, merge_block, right_block);
+            }
+
+            const bool right_reaches_merge = !right_end->getTerminator();
+            if (right_reaches_merge) {
+                builder.SetInsertPoint(right_end);
+                builder.CreateBr(merge_block);
+            }
+
+            builder.SetInsertPoint(merge_block);
+            llvm::PHINode* phi =
+                builder.CreatePHI(builder.getInt1Ty(), 2, is_and ? "and.result" : "or.result");
+            phi->addIncoming(builder.getInt1(!is_and), left_block);
+            if (right_reaches_merge) {
+                phi->addIncoming(right, right_end);
+            }
+            return phi;
+        }
+
+      public:
+        explicit LogicalGenerator(core::GeneratorManager* manager)
+            : m_GENERATOR_MANAGER(manager) {}
+
+        auto can_handle(const Exp& ast_node) const -> bool override {
+            if (ast_node.type != ExpType::LIST || ast_node.list.empty()
+                || ast_node.list[0].type != ExpType::SYMBOL)
+            {
+                return false;
+            }
+
+            const std::string& op = ast_node.list[0].string;
+            return op == "and" || op == "or" || op == "not";
+        }
+
+        auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
+            const std::string& op = ast_node.list[0].string;
+            auto& builder = context.m_BUILDER;
+
+            if (op == "not") {
+                if (ast_node.list.size() != 2) {
+                    LOG_CRITICAL("not requires exactly one operand");
+                }
+                llvm::Value* operand = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
+                if (is_mask(operand)) {
+                    return builder.CreateNot(operand);
+                }
+                llvm::Value* negated = builder.CreateNot(to_bool(operand, op, context));
+                return builder.CreateZExt(negated, builder.getInt32Ty());
+            }
+
+            if (ast_node.list.size() < 3) {
+                LOG_CRITICAL("%s requires at least two operands", op);
+            }
+
+            llvm::Value* first = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
+            if (is_mask(first)) {
+                return generate_mask(ast_node, first, context);
+            }
+
+            llvm::Value* result = to_bool(first, op, context);
+            for (size_t i = 2; i < ast_node.list.size(); ++i) {
+                result = generate_operand(op, result, ast_node.list[i], context);
+            }
+            return builder.CreateZExt(result, builder.getInt32Ty());
+        }
+
+        auto get_priority() const -> int override { return 400; }
+    };
+
+}    // namespace galluz::generators
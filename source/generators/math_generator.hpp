@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <llvm/IR/Intrinsics.h>
+
+#include "../core/generator_manager.hpp"
+#include "../core/types.hpp"
+#include "../logger.hpp"
+
+namespace galluz::generators {
+
+    /**
+     * @brief Math and bit-manipulation builtins lowered to LLVM intrinsics
+     *
+     * Because they are intrinsics rather than libm calls, LLVM constant-folds them, vectorizes
+     * loops that use them and selects single instructions where the target has them (sqrtsd,
+     * roundsd, popcnt, lzcnt, rol, ...). Every builtin also works lane-wise on vector operands.
+     *
+     * Floating point: sqrt floor ceil exp log (one operand), pow copysign (two), fma (three).
+     * Integer or floating point: abs (one), min max (two; unsigned if an operand is).
+     * Integer: popcount clz ctz bswap (one), rotl rotr (value and shift amount).
+     */
+    class MathGenerator : public core::ICodeGenerator {
+      private:
+        core::GeneratorManager* m_GENERATOR_MANAGER;
+
+        enum class Domain : uint8_t
+        {
+            FLOAT,
+            INTEGER,
+            NUMERIC
+        };
+
+        struct Builtin {
+            size_t arity;
+            Domain domain;
+            llvm::Intrinsic::ID float_id;
+            llvm::Intrinsic::ID int_id;
+        };
+
+        inline static const std::unordered_map<std::string, Builtin> BUILTINS = {
+            {"sqrt", {1, Domain::FLOAT, llvm::Intrinsic::sqrt, llvm::Intrinsic::not_intrinsic}},
+            {"floor", {1, Domain::FLOAT, llvm::Intrinsic::floor, llvm::Intrinsic::not_intrinsic}},
+            {"ceil", {1, Domain::FLOAT, llvm::Intrinsic::ceil, llvm::Intrinsic::not_intrinsic}},
+            {"exp", {1, Domain::FLOAT, llvm::Intrinsic::exp, llvm::Intrinsic::not_intrinsic}},
+            {"log", {1, Domain::FLOAT, llvm::Intrinsic::log, llvm::Intrinsic::not_intrinsic}},
+            {"pow", {2, Domain::FLOAT, llvm::Intrinsic::pow, llvm::Intrinsic::not_intrinsic}},
+            {"copysign", {2, Domain::FLOAT, llvm::Intrinsic::copysign, llvm::Intrinsic::not_intrinsic}},
+            {"fma", {3, Domain::FLOAT, llvm::Intrinsic::fma, llvm::Intrinsic::not_intrinsic}},
+            {"abs", {1, Domain::NUMERIC, llvm::Intrinsic::fabs, llvm::Intrinsic::abs}},
+            {"min", {2, Domain::NUMERIC, llvm::Intrinsic::minnum, llvm::Intrinsic::smin}},
+            {"max", {2, Domain::NUMERIC, llvm::Intrinsic::maxnum, llvm::Intrinsic::smax}},
+            {"popcount", {1, Domain::INTEGER, llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::ctpop}},
+            {"clz", {1, Domain::INTEGER, llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::ctlz}},
+            {"ctz", {1, Domain::INTEGER, llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::cttz}},
+            {"bswap", {1, Domain::INTEGER, llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::bswap}},
+            {"rotl", {2, Domain::INTEGER, llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::fshl}},
+            {"rotr", {2, Domain::INTEGER, llvm::Intrinsic::not_intrinsic, llvm::Intrinsic::fshr}},
+        };
+
+        /**
+         * @brief Bring all operands to one type: the vector type among them, or the scalar type
+         *
+         * Integers are converted to double when a floating point operation is wanted; scalars are
+         * broadcast when another operand is a vector.
+         */
+        static auto unify_operands(const std::string& name,
+                                   std::vector<llvm::Value*>& operands,
+                                   bool want_float,
+                                   core::CompilationContext& context) -> llvm::Type* {
+            llvm::VectorType* vector_type = nullptr;
+            for (auto* operand : operands) {
+                if (auto* type = llvm::dyn_cast<llvm::VectorType>(operand->getType())) {
+                    if (vector_type && vector_type != type) {
+                        LOG_CRITICAL("Vector operands of %s must have the same type", name);
+                    }
+                    vector_type = type;
+                }
+            }
+
+            llvm::Type* element_type = nullptr;
+            if (vector_type) {
+                element_type = vector_type->getElementType();
+            } else if (want_float) {
+                element_type = context.m_BUILDER.getDoubleTy();
+            } else {
+                element_type = operands.front()->getType();
+            }
+
+            if (element_type->isFloatingPointTy() != want_float) {
+                LOG_CRITICAL("%s expects %s operands", name, want_float ? "floating point" : "integer");
+            }
+
+            for (auto*& operand : operands) {
+                if (operand->getType()->isVectorTy()) {
+                    continue;
+                }
+                if (!want_float && !operand->getType()->isIntegerTy()) {
+                    LOG_CRITICAL("%s expects integer operands", name);
+                }
+                operand = vector_type ? context.splat(operand, vector_type)
+                                      : context.to_lane(operand, element_type);
+            }
+
+            return vector_type ? static_cast<llvm::Type*>(vector_type) : element_type;
+        }
+
+      public:
+        explicit MathGenerator(core::GeneratorManager* manager)
+            : m_GENERATOR_MANAGER(manager) {}
+
+        auto can_handle(const Exp& ast_node) const -> bool override {
+            return ast_node.type == ExpType::LIST && !ast_node.list.empty()
+                && ast_node.list[0].type == ExpType::SYMBOL && BUILTINS.count(ast_node.list[0].string);
+        }
+
+        auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
+            const std::string& name = ast_node.list[0].string;
+            const Builtin& builtin = BUILTINS.at(name);
+
+            if (ast_node.list.size() - 1 != builtin.arity) {
+                LOG_CRITICAL("%s expects %s operands, got %s",
+                             name,
+                             std::to_string(builtin.arity),
+                             std::to_string(ast_node.list.size() - 1));
+            }
+
+            std::vector<llvm::Value*> operands;
+            for (size_t i = 1; i < ast_node.list.size(); ++i) {
+                operands.push_back(m_GENERATOR_MANAGER->generate_code(ast_node.list[i], context));
+            }
+
+            bool want_float = builtin.domain == Domain::FLOAT;
+            if (builtin.domain == Domain::NUMERIC) {
+                want_float = std::any_of(operands.begin(),
+                                         operands.end(),
+                                         [](llvm::Value* operand)
+                                         { return operand->getType()->isFPOrFPVectorTy(); });
+            }
+
+            auto id = want_float ? builtin.float_id : builtin.int_id;
+            bool is_unsigned = context.is_unsigned(ast_node);
+            const bool is_min_max = id == llvm::Intrinsic::smin || id == llvm::Intrinsic::smax;
+            if (is_min_max && operands[0]->getType()->isIntegerTy()
+                && operands[1]->getType()->isIntegerTy())
+            {
+                // Two scalar integers meet in their common type, as for arithmetic
+                is_unsigned = context.to_common_type(operands[0],
+                                                     context.is_unsigned(ast_node.list[1]),
+                                                     operands[1],
+                                                     context.is_unsigned(ast_node.list[2]));
+            }
+            llvm::Type* type = unify_operands(name, operands, want_float, context);
+            if (is_unsigned) {
+                if (id == llvm::Intrinsic::smin) {
+                    id = llvm::Intrinsic::umin;
+                } else if (id == llvm::Intrinsic::smax) {
+                    id = llvm::Intrinsic::umax;
+                }
+            }
+            if (id == llvm::Intrinsic::bswap && type->getScalarSizeInBits() % 16 != 0) {
+                LOG_CRITICAL("bswap needs 16, 32 or 64-bit integers");
+            }
+            auto* intrinsic = llvm::Intrinsic::getDeclaration(&context.m_MODULE, id, {type});
+
+            auto& builder = context.m_BUILDER;
+            switch (id) {
+                case llvm::Intrinsic::abs:
+                    // INT_MIN stays INT_MIN instead of being poison
+                    return builder.CreateCall(intrinsic, {operands[0], builder.getFalse()});
+                case llvm::Intrinsic::ctlz:
+                case llvm::Intrinsic::cttz:
+                    // Defined for zero: the bit width
+                    return builder.CreateCall(intrinsic, {operands[0], builder.getFalse()});
+                case llvm::Intrinsic::fshl:
+                case llvm::Intrinsic::fshr:
+                    // A funnel shift of a value with itself is a rotate
+                    return builder.CreateCall(intrinsic, {operands[0], operands[0], operands[1]});
+                default:
+                    return builder.CreateCall(intrinsic, operands);
+            }
+        }
+
+        auto get_priority() const -> int override { return 450; }
+    };
+
+}    // namespace galluz::generators
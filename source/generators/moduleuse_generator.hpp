@@ -43,6 +43,8 @@ namespace galluz::generators {
 
             try {
                 m_MODULE_MANAGER->use_module(module_name, context);
+            } catch (const CompileError&) {
+                throw;
             } catch (const std::exception& e) {
                 LOG_CRITICAL("Module use failed: %s", e.what());
             }
@@ -48,13 +48,14 @@ namespace galluz::generators {
                 LOG_CRITICAL("Struct info not found for: %s", struct_name);
             }
 
-            auto* alloca =
-                context.m_BUILDER.CreateAlloca(type_info->llvm_type, nullptr, struct_name + "_inst");
+            auto* alloca = context.create_entry_alloca(type_info->llvm_type, struct_name + "_inst");
+            alloca->setAlignment(context.memory_alignment(type_info->llvm_type, type_info));
 
             auto* zero_init = llvm::ConstantAggregateZero::get(type_info->llvm_type);
             context.m_BUILDER.CreateStore(zero_init, alloca);
 
             std::unordered_map<std::string, llvm::Value*> field_values;
+            std::unordered_map<std::string, const Exp*> field_exps;
 
             for (size_t i = 2; i < ast_node.list.size(); ++i) {
                 const auto& field_assignment = ast_node.list[i];
@@ -83,6 +84,7 @@ namespace galluz::generators {
 
                 llvm::Value* field_value = m_GENERATOR_MANAGER->generate_code(field_value_exp, context);
                 field_values[field_name] = field_value;
+                field_exps[field_name] = &field_value_exp;
             }
 
             for (const auto& [field_name, field_value] : field_values) {
@@ -93,25 +95,14 @@ namespace galluz::generators {
 
                 llvm::Value* casted_value = field_value;
                 if (field_value->getType() != field_type_info->llvm_type) {
-                    if (field_type_info->kind == core::TypeKind::INT && field_value->getType()->isIntegerTy())
+                    if (field_type_info->is_numeric()
+                        && (field_value->getType()->isIntegerTy()
+                            || field_value->getType()->isFloatingPointTy()))
                     {
-                        casted_value =
-                            context.m_BUILDER.CreateIntCast(field_value, field_type_info->llvm_type, true);
-                    } else if (field_type_info->kind == core::TypeKind::DOUBLE
-                               && field_value->getType()->isFloatingPointTy())
-                    {
-                        casted_value =
-                            context.m_BUILDER.CreateFPCast(field_value, field_type_info->llvm_type);
-                    } else if (field_type_info->kind == core::TypeKind::DOUBLE
-                               && field_value->getType()->isIntegerTy())
-                    {
-                        casted_value =
-                            context.m_BUILDER.CreateSIToFP(field_value, field_type_info->llvm_type);
-                    } else if (field_type_info->kind == core::TypeKind::INT
-                               && field_value->getType()->isFloatingPointTy())
-                    {
-                        casted_value =
-                            context.m_BUILDER.CreateFPToSI(field_value, field_type_info->llvm_type);
+                        casted_value = context.convert_scalar(field_value,
+                                                              context.is_unsigned(*field_exps.at(field_name)),
+                                                              field_type_info->llvm_type,
+                                                              field_type_info->is_unsigned);
                     } else if (field_type_info->kind == core::TypeKind::BOOL
                                && field_value->getType()->isIntegerTy())
                     {
@@ -126,8 +117,8 @@ namespace galluz::generators {
                     }
                 }
 
-                llvm::Value* gep =
-                    context.m_BUILDER.CreateStructGEP(type_info->llvm_type, alloca, field_index, field_name);
+                llvm::Value* gep = context.m_BUILDER.CreateStructGEP(
+                    type_info->llvm_type, alloca, struct_info->fields[field_index].index, field_name);
                 context.m_BUILDER.CreateStore(casted_value, gep);
             }
 
@@ -1,9 +1,14 @@
 #pragma once
 
 #include "../core/types.hpp"
+#include "../logger.hpp"
 
 namespace galluz::generators {
 
+    /**
+     * @brief Integer literals: 42 is an int, or an i64 if it does not fit in 32 bits; a suffix
+     * (-7i8, 255u8, 40000u16, 1i64, ...) gives the type explicitly
+     */
     class NumberGenerator : public core::ICodeGenerator {
       public:
         auto can_handle(const Exp& ast_node) const -> bool override {
@@ -11,7 +16,26 @@ namespace galluz::generators {
         }
 
         auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
-            return llvm::ConstantInt::get(context.m_BUILDER.getInt32Ty(), ast_node.number);
+            const auto value = static_cast<int64_t>(ast_node.number);
+            if (ast_node.suffix.empty()) {
+                if (ast_node.out_of_range) {
+                    LOG_CRITICAL("%s does not fit in i64", ast_node.string);
+                }
+                auto* type = llvm::ConstantInt::isValueValidForType(context.m_BUILDER.getInt32Ty(), value)
+                    ? context.m_BUILDER.getInt32Ty()
+                    : context.m_BUILDER.getInt64Ty();
+                return llvm::ConstantInt::get(type, static_cast<uint64_t>(value), true);
+            }
+
+            auto* type_info = context.type_system->get_type(ast_node.suffix);
+            auto* type = llvm::cast<llvm::IntegerType>(type_info->llvm_type);
+            const bool fits = type_info->is_unsigned
+                ? llvm::ConstantInt::isValueValidForType(type, static_cast<uint64_t>(value))
+                : llvm::ConstantInt::isValueValidForType(type, value);
+            if (ast_node.out_of_range || !fits) {
+                LOG_CRITICAL("%s does not fit in %s", ast_node.string, ast_node.suffix);
+            }
+            return llvm::ConstantInt::get(type, static_cast<uint64_t>(value), true);
         }
 
         auto get_priority() const -> int override { return 1000; }
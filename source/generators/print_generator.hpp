@@ -65,8 +65,13 @@ namespace galluz::generators {
             for (size_t i = 2; i < ast_node.list.size(); ++i) {
                 llvm::Value* arg = m_GENERATOR_MANAGER->generate_code(ast_node.list[i], context);
 
-                if (arg->getType()->isIntegerTy(1)) {
-                    arg = context.m_BUILDER.CreateZExt(arg, context.m_BUILDER.getInt32Ty());
+                // C variadic promotions: narrow integers to int, float to double
+                llvm::Type* type = arg->getType();
+                if (type->isIntegerTy() && type->getIntegerBitWidth() < 32) {
+                    const bool is_unsigned = type->isIntegerTy(1) || context.is_unsigned(ast_node.list[i]);
+                    arg = context.m_BUILDER.CreateIntCast(arg, context.m_BUILDER.getInt32Ty(), !is_unsigned);
+                } else if (type->isFloatTy()) {
+                    arg = context.m_BUILDER.CreateFPExt(arg, context.m_BUILDER.getDoubleTy());
                 }
 
                 printf_args.push_back(arg);
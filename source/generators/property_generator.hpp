@@ -93,7 +93,7 @@ namespace galluz::generators {
             }
 
             llvm::Value* gep = context.m_BUILDER.CreateStructGEP(
-                struct_info->llvm_type, struct_value, field_index, field_name);
+                struct_info->llvm_type, struct_value, struct_info->fields[field_index].index, field_name);
 
             return context.m_BUILDER.CreateLoad(field_type_info->llvm_type, gep, field_name);
         }
@@ -148,20 +148,13 @@ namespace galluz::generators {
             }
 
             if (new_value->getType() != field_type_info->llvm_type) {
-                if (field_type_info->kind == core::TypeKind::INT && new_value->getType()->isIntegerTy()) {
-                    new_value = context.m_BUILDER.CreateIntCast(new_value, field_type_info->llvm_type, true);
-                } else if (field_type_info->kind == core::TypeKind::DOUBLE
-                           && new_value->getType()->isFloatingPointTy())
+                if (field_type_info->is_numeric()
+                    && (new_value->getType()->isIntegerTy() || new_value->getType()->isFloatingPointTy()))
                 {
-                    new_value = context.m_BUILDER.CreateFPCast(new_value, field_type_info->llvm_type);
-                } else if (field_type_info->kind == core::TypeKind::DOUBLE
-                           && new_value->getType()->isIntegerTy())
-                {
-                    new_value = context.m_BUILDER.CreateSIToFP(new_value, field_type_info->llvm_type);
-                } else if (field_type_info->kind == core::TypeKind::INT
-                           && new_value->getType()->isFloatingPointTy())
-                {
-                    new_value = context.m_BUILDER.CreateFPToSI(new_value, field_type_info->llvm_type);
+                    new_value = context.convert_scalar(new_value,
+                                                       context.is_unsigned(ast_node.list[3]),
+                                                       field_type_info->llvm_type,
+                                                       field_type_info->is_unsigned);
                 } else if (field_type_info->kind == core::TypeKind::BOOL
                            && new_value->getType()->isIntegerTy())
                 {
@@ -173,7 +166,7 @@ namespace galluz::generators {
             }
 
             llvm::Value* gep = context.m_BUILDER.CreateStructGEP(
-                struct_info->llvm_type, struct_value, field_index, field_name);
+                struct_info->llvm_type, struct_value, struct_info->fields[field_index].index, field_name);
 
             context.m_BUILDER.CreateStore(new_value, gep);
             return new_value;
@@ -27,10 +27,12 @@ namespace galluz::generators {
 
         auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
             context.push_scope();
+            m_GENERATOR_MANAGER->declare_forms(ast_node.list, 1, context);
 
             llvm::Value* last_result = context.m_BUILDER.getInt32(0);
 
             for (size_t i = 1; i < ast_node.list.size(); ++i) {
+                context.continue_after_terminator();
                 last_result = m_GENERATOR_MANAGER->generate_code(ast_node.list[i], context);
             }
 
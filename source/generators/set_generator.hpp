@@ -50,28 +50,22 @@ namespace galluz::generators {
             llvm::Type* value_type = new_value->getType();
 
             auto* var_info = context.find_variable(var_name);
+            if (var_info && llvm::isa<llvm::PHINode>(var_info->value)) {
+                LOG_CRITICAL("Cannot set %s: a for loop variable is read-only", var_name);
+            }
             if (var_info) {
                 if (var_info->type_info && var_info->type_info->llvm_type != value_type) {
                     if (var_info->type_info->kind == core::TypeKind::STRUCT) {
                         if (!value_type->isStructTy() && !value_type->isPointerTy()) {
                             LOG_CRITICAL("Type mismatch in set operation for struct variable: %s", var_name);
                         }
-                    } else if (var_info->type_info->kind == core::TypeKind::INT && value_type->isIntegerTy())
-                    {
-                        new_value =
-                            context.m_BUILDER.CreateIntCast(new_value, var_info->type_info->llvm_type, true);
-                    } else if (var_info->type_info->kind == core::TypeKind::DOUBLE
-                               && value_type->isFloatingPointTy())
-                    {
-                        new_value = context.m_BUILDER.CreateFPCast(new_value, var_info->type_info->llvm_type);
-                    } else if (var_info->type_info->kind == core::TypeKind::DOUBLE
-                               && value_type->isIntegerTy())
-                    {
-                        new_value = context.m_BUILDER.CreateSIToFP(new_value, var_info->type_info->llvm_type);
-                    } else if (var_info->type_info->kind == core::TypeKind::INT
-                               && value_type->isFloatingPointTy())
+                    } else if (var_info->type_info->is_numeric()
+                               && (value_type->isIntegerTy() || value_type->isFloatingPointTy()))
                     {
-                        new_value = context.m_BUILDER.CreateFPToSI(new_value, var_info->type_info->llvm_type);
+                        new_value = context.convert_scalar(new_value,
+                                                           context.is_unsigned(value_exp),
+                                                           var_info->type_info->llvm_type,
+                                                           var_info->type_info->is_unsigned);
                     } else if (var_info->type_info->kind == core::TypeKind::BOOL && value_type->isIntegerTy())
                     {
                         new_value =
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <llvm/IR/MDBuilder.h>
+
+#include "../core/generator_manager.hpp"
+#include "../core/types.hpp"
+#include "../logger.hpp"
+
+namespace galluz::generators {
+
+    /**
+     * @brief Structure-of-arrays containers of struct types
+     *
+     * (soa-vec Struct n)         n zeroed elements, one contiguous column per field
+     * (soa-len v)                number of elements, as an i64
+     * (soa-get v i field)        field of element i: one load from the field's column
+     * (soa-set v i field value)  one store into the field's column; returns value
+     * (soa-free v)               release the columns
+     *
+     * The container is a value of type soa-vec<Struct>, {length, column pointers}, and is copied
+     * like a vector; copies share the columns. Columns are separate 64-byte aligned allocations, so
+     * accesses to different fields carry alias scopes saying they never overlap: a loop over a
+     * few fields vectorizes without runtime overlap checks and only touches those columns.
+     * Indices are not bounds-checked.
+     */
+    class SoaGenerator : public core::ICodeGenerator {
+      private:
+        core::GeneratorManager* m_GENERATOR_MANAGER;
+
+        /// Columns are aligned to a cache line, and their sizes rounded up to whole lines
+        static const constexpr uint64_t COLUMN_ALIGNMENT = 64;
+
+        inline static const std::unordered_set<std::string> BUILTINS = {
+            "soa-vec", "soa-len", "soa-get", "soa-set", "soa-free"};
+
+        /// Per struct, the alias scope of each field's column
+        std::unordered_map<const core::StructInfo*, std::vector<llvm::MDNode*>> m_COLUMN_SCOPES;
+
+        auto column_scopes(const core::StructInfo* struct_info, llvm::LLVMContext& ctx)
+            -> const std::vector<llvm::MDNode*>& {
+            auto it = m_COLUMN_SCOPES.find(struct_info);
+            if (it != m_COLUMN_SCOPES.end()) {
+                return it->second;
+            }
+
+            llvm::MDBuilder builder(ctx);
+            llvm::MDNode* domain =
+                builder.createAnonymousAliasScopeDomain(core::TypeSystem::soa_type_name(struct_info->name));
+            std::vector<llvm::MDNode*> scopes;
+            for (const auto& field : struct_info->fields) {
+                scopes.push_back(builder.createAnonymousAliasScope(domain, field.name));
+            }
+            return m_COLUMN_SCOPES[struct_info] = std::move(scopes);
+        }
+
+        auto generate_container(const Exp& ast_node, core::CompilationContext& context)
+            -> std::pair<llvm::Value*, core::TypeInfo*> {
+            const std::string& name = ast_node.list[0].string;
+
+            llvm::Value* container = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
+            auto* type_info = context.type_system->get_soa_type(container->getType());
+            if (!type_info) {
+                LOG_CRITICAL("%s expects a soa-vec as its first operand", name);
+            }
+            return {container, type_info};
+        }
+
+        static auto to_length(llvm::Value* value, const Exp& exp, core::CompilationContext& context)
+            -> llvm::Value* {
+            if (!value->getType()->isIntegerTy()) {
+                LOG_CRITICAL("soa-vec lengths and indices must be integers");
+            }
+            return context.convert_scalar(
+                value, context.is_unsigned(exp), context.m_BUILDER.getInt64Ty(), context.is_unsigned(exp));
+        }
+
+        /**
+         * @brief Address of element @p ast_node.list[2] in the column of field @p ast_node.list[3]
+         */
+        auto generate_element(const Exp& ast_node, core::CompilationContext& context)
+            -> std::tuple<llvm::Value*, const core::StructInfo*, size_t> {
+            const std::string& name = ast_node.list[0].string;
+            auto [container, type_info] = generate_container(ast_node, context);
+            const auto* struct_info = type_info->struct_info;
+
+            const auto& index_exp = ast_node.list[2];
+            llvm::Value* index =
+                to_length(m_GENERATOR_MANAGER->generate_code(index_exp, context), index_exp, context);
+
+            const auto& field_exp = ast_node.list[3];
+            if (field_exp.type != ExpType::SYMBOL) {
+                LOG_CRITICAL("%s expects a field name after the index", name);
+            }
+            auto it = struct_info->field_indices.find(field_exp.string);
+            if (it == struct_info->field_indices.end()) {
+                LOG_CRITICAL("Struct %s has no field named %s", struct_info->name, field_exp.string);
+            }
+            const size_t field_index = it->second;
+            const auto& field = struct_info->fields[field_index];
+
+            auto& builder = context.m_BUILDER;
+            llvm::Value* column = builder.CreateExtractValue(
+                container, {static_cast<unsigned>(field_index + 1)}, field.name + ".column");
+            llvm::Value* address =
+                builder.CreateInBoundsGEP(field.type->llvm_type, column, index, field.name + ".addr");
+            return {address, struct_info, field_index};
+        }
+
+        auto tag_column_access(llvm::Instruction* access,
+                               const core::StructInfo* struct_info,
+                               size_t field_index,
+                               llvm::LLVMContext& ctx) -> void {
+            const auto& scopes = column_scopes(struct_info, ctx);
+            std::vector<llvm::Metadata*> others;
+            for (size_t i = 0; i < scopes.size(); ++i) {
+                if (i != field_index) {
+                    others.push_back(scopes[i]);
+                }
+            }
+            access->setMetadata(llvm::LLVMContext::MD_alias_scope,
+                                llvm::MDNode::get(ctx, {scopes[field_index]}));
+            if (!others.empty()) {
+                access->setMetadata(llvm::LLVMContext::MD_noalias, llvm::MDNode::get(ctx, others));
+            }
+        }
+
+        auto generate_new(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() != 3 || ast_node.list[1].type != ExpType::SYMBOL) {
+                LOG_CRITICAL("Invalid soa-vec: (soa-vec StructName length)");
+            }
+
+            const std::string& struct_name = ast_node.list[1].string;
+            auto* type_info = context.type_system->get_type(core::TypeSystem::soa_type_name(struct_name));
+            if (!type_info) {
+                LOG_CRITICAL("Unknown struct type: %s", struct_name);
+            }
+
+            auto& builder = context.m_BUILDER;
+            const auto& layout = context.m_MODULE.getDataLayout();
+            auto* i64 = builder.getInt64Ty();
+            auto aligned_alloc = context.m_MODULE.getOrInsertFunction(
+                "aligned_alloc", llvm::FunctionType::get(builder.getInt8PtrTy(), {i64, i64}, false));
+
+            const auto& length_exp = ast_node.list[2];
+            llvm::Value* length =
+                to_length(m_GENERATOR_MANAGER->generate_code(length_exp, context), length_exp, context);
+
+            llvm::Value* container = llvm::UndefValue::get(type_info->llvm_type);
+            container = builder.CreateInsertValue(container, length, {0});
+
+            const auto& fields = type_info->struct_info->fields;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                auto* field_type = fields[i].type->llvm_type;
+                llvm::Value* bytes = builder.CreateMul(
+                    length, builder.getInt64(layout.getTypeAllocSize(field_type)), fields[i].name + ".bytes");
+                // aligned_alloc wants a multiple of the alignment
+                bytes = builder.CreateAnd(builder.CreateAdd(bytes, builder.getInt64(COLUMN_ALIGNMENT - 1)),
+                                          builder.getInt64(~(COLUMN_ALIGNMENT - 1)));
+
+                auto* column = builder.CreateCall(
+                    aligned_alloc, {builder.getInt64(COLUMN_ALIGNMENT), bytes}, fields[i].name + ".column");
+                column->addRetAttr(
+                    llvm::Attribute::getWithAlignment(context.m_CTX, llvm::Align(COLUMN_ALIGNMENT)));
+                builder.CreateMemSet(column, builder.getInt8(0), bytes, llvm::MaybeAlign(COLUMN_ALIGNMENT));
+
+                container = builder.CreateInsertValue(
+                    container,
+                    builder.CreateBitCast(column, field_type->getPointerTo()),
+                    {static_cast<unsigned>(i + 1)});
+            }
+            return container;
+        }
+
+        auto generate_free(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            auto [container, type_info] = generate_container(ast_node, context);
+
+            auto& builder = context.m_BUILDER;
+            auto free = context.m_MODULE.getOrInsertFunction(
+                "free", llvm::FunctionType::get(builder.getVoidTy(), builder.getInt8PtrTy(), false));
+            for (size_t i = 0; i < type_info->struct_info->fields.size(); ++i) {
+                llvm::Value* column = builder.CreateExtractValue(container, {static_cast<unsigned>(i + 1)});
+                builder.CreateCall(free, builder.CreateBitCast(column, builder.getInt8PtrTy()));
+            }
+            return builder.getInt32(0);
+        }
+
+      public:
+        explicit SoaGenerator(core::GeneratorManager* manager)
+            : m_GENERATOR_MANAGER(manager) {}
+
+        auto can_handle(const Exp& ast_node) const -> bool override {
+            return ast_node.type == ExpType::LIST && !ast_node.list.empty()
+                && ast_node.list[0].type == ExpType::SYMBOL && BUILTINS.count(ast_node.list[0].string);
+        }
+
+        auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
+            const std::string& name = ast_node.list[0].string;
+            auto& builder = context.m_BUILDER;
+
+            if (name == "soa-vec") {
+                return generate_new(ast_node, context);
+            }
+
+            if (name == "soa-len" || name == "soa-free") {
+                if (ast_node.list.size() != 2) {
+                    LOG_CRITICAL("Invalid %s: (%s container)", name, name);
+                }
+                if (name == "soa-free") {
+                    return generate_free(ast_node, context);
+                }
+                return builder.CreateExtractValue(
+                    generate_container(ast_node, context).first, {0}, "soa.length");
+            }
+
+            if (name == "soa-get") {
+                if (ast_node.list.size() != 4) {
+                    LOG_CRITICAL("Invalid soa-get: (soa-get container index field)");
+                }
+                auto [address, struct_info, field_index] = generate_element(ast_node, context);
+                const auto& field = struct_info->fields[field_index];
+                auto* load = builder.CreateLoad(field.type->llvm_type, address, field.name);
+                tag_column_access(load, struct_info, field_index, context.m_CTX);
+                return load;
+            }
+
+            if (ast_node.list.size() != 5) {
+                LOG_CRITICAL("Invalid soa-set: (soa-set container index field value)");
+            }
+            auto [address, struct_info, field_index] = generate_element(ast_node, context);
+            const auto& field = struct_info->fields[field_index];
+
+            llvm::Value* value = m_GENERATOR_MANAGER->generate_code(ast_node.list[4], context);
+            if (value->getType() != field.type->llvm_type) {
+                if (field.type->is_numeric()
+                    && (value->getType()->isIntegerTy() || value->getType()->isFloatingPointTy()))
+                {
+                    value = context.convert_scalar(value,
+                                                   context.is_unsigned(ast_node.list[4]),
+                                                   field.type->llvm_type,
+                                                   field.type->is_unsigned);
+                } else if (field.type->kind == core::TypeKind::BOOL && value->getType()->isIntegerTy()) {
+                    value = builder.CreateIntCast(value, builder.getInt1Ty(), false);
+                } else {
+                    LOG_CRITICAL("Type mismatch in soa-set for field: %s", field.name);
+                }
+            }
+
+            auto* store = builder.CreateStore(value, address);
+            tag_column_access(store, struct_info, field_index, context.m_CTX);
+            return value;
+        }
+
+        auto get_priority() const -> int override { return 450; }
+    };
+
+}    // namespace galluz::generators
@@ -42,8 +42,7 @@ namespace galluz::generators {
                 LOG_CRITICAL("Unknown struct type: %s", struct_name);
             }
 
-            auto* alloca =
-                context.m_BUILDER.CreateAlloca(type_info->llvm_type, nullptr, struct_name + "_inst");
+            auto* alloca = context.create_entry_alloca(type_info->llvm_type, struct_name + "_inst");
 
             auto* zero_init = llvm::ConstantAggregateZero::get(type_info->llvm_type);
             context.m_BUILDER.CreateStore(zero_init, alloca);
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "../core/generator_manager.hpp"
 #include "../core/types.hpp"
+#include "../logger.hpp"
 
 namespace galluz::generators {
 
@@ -9,6 +14,116 @@ namespace galluz::generators {
       private:
         core::GeneratorManager* m_GENERATOR_MANAGER;
 
+        static auto is_resolvable(const Exp& ast_node, core::CompilationContext& context) -> bool {
+            if (ast_node.list.size() < 3 || ast_node.list[1].type != ExpType::SYMBOL
+                || ast_node.list.back().type != ExpType::LIST)
+            {
+                return false;
+            }
+
+            return std::all_of(ast_node.list.back().list.begin(),
+                               ast_node.list.back().list.end(),
+                               [&context](const Exp& field_exp)
+                               {
+                                   return field_exp.type == ExpType::LIST && field_exp.list.size() >= 2
+                                       && field_exp.list[0].type == ExpType::SYMBOL
+                                       && field_exp.list[1].type == ExpType::SYMBOL
+                                       && !field_exp.list[1].string.empty()
+                                       && field_exp.list[1].string[0] == '!'
+                                       && context.type_system->get_type(field_exp.list[1].string.substr(1));
+                               });
+        }
+
+        /**
+         * @brief Read the power of two following an :align at @p index
+         */
+        static auto parse_alignment(const Exp& list, size_t index) -> unsigned {
+            if (index >= list.list.size() || list.list[index].type != ExpType::NUMBER
+                || list.list[index].number < 1 || list.list[index].number > 4096
+                || (list.list[index].number & (list.list[index].number - 1)) != 0)
+            {
+                LOG_CRITICAL(":align needs a power of two from 1 to 4096");
+            }
+            return static_cast<unsigned>(list.list[index].number);
+        }
+
+        /**
+         * @brief Options between the struct name and its fields: :packed, :ordered, :align N
+         */
+        static auto parse_layout_options(const Exp& ast_node) -> core::StructLayoutOptions {
+            core::StructLayoutOptions options;
+            const size_t fields_index = ast_node.list.size() - 1;
+
+            for (size_t i = 2; i < fields_index; ++i) {
+                const auto& option = ast_node.list[i];
+                if (option.type != ExpType::SYMBOL || option.string.empty() || option.string[0] != ':') {
+                    LOG_CRITICAL("Expected a layout option such as :packed before the struct fields");
+                }
+
+                if (option.string == ":packed") {
+                    options.packed = true;
+                } else if (option.string == ":ordered") {
+                    options.ordered = true;
+                } else if (option.string == ":align" && i + 1 < fields_index) {
+                    options.align = parse_alignment(ast_node, ++i);
+                } else if (option.string == ":align") {
+                    LOG_CRITICAL(":align needs a power of two from 1 to 4096");
+                } else {
+                    LOG_CRITICAL("Unknown struct option %s", option.string);
+                }
+            }
+
+            if (options.packed && options.align > 1) {
+                LOG_CRITICAL("Struct options :packed and :align conflict");
+            }
+            return options;
+        }
+
+        /**
+         * @brief Log where each field ended up and how much padding the struct carries
+         */
+        static auto report_layout(const core::StructInfo& struct_info, const llvm::DataLayout& layout)
+            -> void {
+            std::vector<const core::StructField*> by_offset;
+            for (const auto& field : struct_info.fields) {
+                by_offset.push_back(&field);
+            }
+            std::sort(by_offset.begin(),
+                      by_offset.end(),
+                      [](const auto* a, const auto* b) { return a->offset < b->offset; });
+
+            LOG_INFO("struct %s: %s bytes, aligned to %s%s",
+                     struct_info.name,
+                     std::to_string(struct_info.size),
+                     std::to_string(struct_info.align),
+                     struct_info.packed ? ", packed" : "");
+
+            uint64_t end = 0;
+            uint64_t padding = 0;
+            for (const auto* field : by_offset) {
+                if (field->offset > end) {
+                    LOG_INFO("  %s: %s bytes of padding",
+                             std::to_string(end),
+                             std::to_string(field->offset - end));
+                    padding += field->offset - end;
+                }
+                const uint64_t size = layout.getTypeAllocSize(field->type->llvm_type);
+                LOG_INFO("  %s: %s !%s (%s bytes)",
+                         std::to_string(field->offset),
+                         field->name,
+                         field->type->name,
+                         std::to_string(size));
+                end = field->offset + size;
+            }
+            if (struct_info.size > end) {
+                LOG_INFO("  %s: %s bytes of padding",
+                         std::to_string(end),
+                         std::to_string(struct_info.size - end));
+                padding += struct_info.size - end;
+            }
+            LOG_INFO("  %s bytes of padding in total", std::to_string(padding));
+        }
+
       public:
         explicit StructGenerator(core::GeneratorManager* manager)
             : m_GENERATOR_MANAGER(manager) {}
@@ -27,11 +142,12 @@ namespace galluz::generators {
 
         auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
             if (ast_node.list.size() < 3) {
-                LOG_CRITICAL("Invalid struct definition: (struct name ((field1 !type) (field2 !type) ...))");
+                LOG_CRITICAL(
+                    "Invalid struct definition: (struct name [options] ((field1 !type) (field2 !type) ...))");
             }
 
             const auto& name_exp = ast_node.list[1];
-            const auto& fields_exp = ast_node.list[2];
+            const auto& fields_exp = ast_node.list.back();
 
             if (name_exp.type != ExpType::SYMBOL) {
                 LOG_CRITICAL("Struct name must be a symbol");
@@ -43,11 +159,14 @@ namespace galluz::generators {
                 LOG_CRITICAL("Struct fields must be a list");
             }
 
-            std::vector<std::pair<std::string, core::TypeInfo*>> fields;
+            const core::StructLayoutOptions options = parse_layout_options(ast_node);
+            std::vector<core::StructField> fields;
 
             for (const auto& field_exp : fields_exp.list) {
-                if (field_exp.type != ExpType::LIST || field_exp.list.size() != 2) {
-                    LOG_CRITICAL("Field definition must be (name !type)");
+                if (field_exp.type != ExpType::LIST
+                    || (field_exp.list.size() != 2 && field_exp.list.size() != 4))
+                {
+                    LOG_CRITICAL("Field definition must be (name !type) or (name !type :align N)");
                 }
 
                 const auto& field_name_exp = field_exp.list[0];
@@ -71,14 +190,38 @@ namespace galluz::generators {
                     LOG_CRITICAL("Unknown type: %s", type_str);
                 }
 
-                fields.emplace_back(field_name, type_info);
+                unsigned align = 0;
+                if (field_exp.list.size() == 4) {
+                    if (field_exp.list[2].type != ExpType::SYMBOL || field_exp.list[2].string != ":align") {
+                        LOG_CRITICAL("Unknown field option for %s, expected :align N", field_name);
+                    }
+                    align = parse_alignment(field_exp, 3);
+                }
+
+                fields.push_back({field_name, type_info, 0, align});
+            }
+
+            if (context.type_system->get_struct_info(struct_name)) {
+                return context.m_BUILDER.getInt64(0);
             }
 
-            context.type_system->define_struct(struct_name, fields);
+            auto* struct_info = context.type_system->define_struct(
+                struct_name, std::move(fields), options, context.m_MODULE.getDataLayout());
+            if (context.report_struct_layout) {
+                report_layout(*struct_info, context.m_MODULE.getDataLayout());
+            }
 
             return context.m_BUILDER.getInt64(0);
         }
 
+        auto declare(const Exp& ast_node, core::CompilationContext& context, core::DeclarationPass pass)
+            -> void override {
+            // generate() skips structs already defined, so at the struct's own position it is a no-op
+            if (pass == core::DeclarationPass::TYPES && is_resolvable(ast_node, context)) {
+                generate(ast_node, context);
+            }
+        }
+
         auto get_priority() const -> int override { return 950; }
     };
 
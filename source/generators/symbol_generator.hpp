@@ -42,9 +42,11 @@ namespace galluz::generators {
             }
 
             std::unordered_set<std::string> keywords = {
-                "import", "moduleuse", "defmodule", "defn",    "var",     "global", "set",
-                "scope",  "do",        "fprint",    "if",      "while",   "break",  "continue",
-                "struct", "new",       "getprop",   "setprop", "hasprop", "finput"};
+                "import",   "moduleuse", "defmodule", "defn",     "var",     "global",  "set",
+                "scope",    "do",        "fprint",    "if",       "while",   "for",     "break",
+                "continue", "struct",    "new",       "getprop",  "setprop", "hasprop", "finput",
+                "cond",     "match",     "and",       "or",       "not",     "cast",    "soa-vec",
+                "soa-len",  "soa-get",   "soa-set",   "soa-free"};
 
             if (keywords.count(symbol)) {
                 LOG_CRITICAL("Undefined symbol: %s (this is a keyword)", symbol);
@@ -52,6 +54,9 @@ namespace galluz::generators {
 
             if (symbol.find('.') != std::string::npos && m_MODULE_MANAGER) {
                 auto [module_value, member_name] = m_MODULE_MANAGER->resolve_symbol(symbol);
+                if (auto* func = llvm::dyn_cast_or_null<llvm::Function>(module_value)) {
+                    m_MODULE_MANAGER->materialize(func, context);
+                }
                 if (module_value) {
                     return module_value;
                 }
@@ -73,7 +78,10 @@ namespace galluz::generators {
                         return var_info->value;
                     }
 
-                    if (llvm::isa<llvm::Argument>(var_info->value)) {
+                    // Arguments and `for` induction variables are SSA values, not storage
+                    if (llvm::isa<llvm::Argument>(var_info->value)
+                        || llvm::isa<llvm::PHINode>(var_info->value))
+                    {
                         return var_info->value;
                     }
 
@@ -83,6 +91,9 @@ namespace galluz::generators {
 
             auto* func_info = context.find_function(symbol);
             if (func_info) {
+                if (m_MODULE_MANAGER) {
+                    m_MODULE_MANAGER->materialize(func_info->function, context);
+                }
                 return func_info->function;
             }
 
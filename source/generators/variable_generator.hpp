@@ -3,6 +3,7 @@
 #include <llvm/IR/GlobalVariable.h>
 
 #include "../core/generator_manager.hpp"
+#include "../core/type_inference.hpp"
 #include "../core/types.hpp"
 #include "../logger.hpp"
 
@@ -61,12 +62,29 @@ namespace galluz::generators {
                 if (!type_info) {
                     LOG_CRITICAL("Unknown type: %s", type_str.c_str());
                 }
+                if (type_info->kind == core::TypeKind::UNKNOWN) {
+                    // !auto: the static type of the initializer, worked out before it is generated
+                    if (!has_initializer) {
+                        LOG_CRITICAL("Variable %s is auto and needs an initializer", var_name.c_str());
+                    }
+                    type_info = core::TypeInference(context).infer(ast_node.list[2]);
+                    if (!type_info || type_info->kind == core::TypeKind::VOID) {
+                        LOG_CRITICAL("Cannot infer the type of %s; give it an explicit type",
+                                     var_name.c_str());
+                    }
+                }
             } else if (name_exp.type == ExpType::SYMBOL) {
                 var_name = name_exp.string;
                 if (has_initializer) {
                     llvm::Value* init_value = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
                     llvm::Type* value_type = init_value->getType();
 
+                    // An untyped variable keeps the signedness of its initializer, or its soa-vec type
+                    core::TypeInfo* inferred_type = context.type_system->get_soa_type(value_type);
+                    if (value_type->isIntegerTy() && context.is_unsigned(ast_node.list[2])) {
+                        inferred_type = context.type_system->get_integer_type(value_type, true);
+                    }
+
                     if (is_global) {
                         llvm::Constant* const_init = llvm::dyn_cast<llvm::Constant>(init_value);
                         if (!const_init) {
@@ -76,25 +94,24 @@ namespace galluz::generators {
                         context.m_MODULE.getOrInsertGlobal(var_name, value_type);
                         auto* variable = context.m_MODULE.getNamedGlobal(var_name);
 
-                        variable->setAlignment(llvm::MaybeAlign(8));
+                        variable->setAlignment(context.memory_alignment(value_type));
                         variable->setConstant(false);
                         variable->setInitializer(const_init);
 
-                        context.add_variable(var_name, variable, value_type, nullptr, true);
+                        context.add_variable(var_name, variable, value_type, inferred_type, true);
                         return init_value;
                     } else {
-                        auto* alloca = context.m_BUILDER.CreateAlloca(value_type, nullptr, var_name);
+                        auto* alloca = context.create_entry_alloca(value_type, var_name);
                         context.m_BUILDER.CreateStore(init_value, alloca);
 
-                        context.add_variable(var_name, alloca, value_type, nullptr, false);
+                        context.add_variable(var_name, alloca, value_type, inferred_type, false);
                         return alloca;
                     }
                 } else {
                     if (is_global) {
                         LOG_CRITICAL("Global variables must have an initializer");
                     }
-                    auto* alloca =
-                        context.m_BUILDER.CreateAlloca(context.m_BUILDER.getInt32Ty(), nullptr, var_name);
+                    auto* alloca = context.create_entry_alloca(context.m_BUILDER.getInt32Ty(), var_name);
                     auto* zero = context.m_BUILDER.getInt32(0);
                     context.m_BUILDER.CreateStore(zero, alloca);
 
@@ -111,18 +128,21 @@ namespace galluz::generators {
                 }
 
                 llvm::Type* value_type = type_info->llvm_type;
-                auto* alloca = context.m_BUILDER.CreateAlloca(value_type, nullptr, var_name);
+                auto* alloca = context.create_entry_alloca(value_type, var_name);
 
                 llvm::Value* zero_init = nullptr;
                 if (type_info->kind == core::TypeKind::INT) {
-                    zero_init = context.m_BUILDER.getInt32(0);
+                    zero_init = llvm::ConstantInt::get(value_type, 0);
                 } else if (type_info->kind == core::TypeKind::DOUBLE) {
-                    zero_init = llvm::ConstantFP::get(context.m_BUILDER.getDoubleTy(), 0.0);
+                    zero_init = llvm::ConstantFP::get(value_type, 0.0);
                 } else if (type_info->kind == core::TypeKind::BOOL) {
                     zero_init = context.m_BUILDER.getInt1(false);
                 } else if (type_info->kind == core::TypeKind::STRING) {
                     zero_init = llvm::ConstantPointerNull::get(context.m_BUILDER.getInt8Ty()->getPointerTo());
-                } else if (type_info->kind == core::TypeKind::STRUCT) {
+                } else if (type_info->kind == core::TypeKind::STRUCT
+                           || type_info->kind == core::TypeKind::VECTOR
+                           || type_info->kind == core::TypeKind::SOA)
+                {
                     zero_init = llvm::ConstantAggregateZero::get(value_type);
                 }
 
@@ -142,20 +162,14 @@ namespace galluz::generators {
                         LOG_CRITICAL("Type mismatch for struct variable %s", var_name.c_str());
                     }
                 } else if (init_value->getType() != type_info->llvm_type) {
-                    if (type_info->kind == core::TypeKind::INT && init_value->getType()->isIntegerTy()) {
-                        init_value = context.m_BUILDER.CreateIntCast(init_value, type_info->llvm_type, true);
-                    } else if (type_info->kind == core::TypeKind::DOUBLE
-                               && init_value->getType()->isFloatingPointTy())
-                    {
-                        init_value = context.m_BUILDER.CreateFPCast(init_value, type_info->llvm_type);
-                    } else if (type_info->kind == core::TypeKind::DOUBLE
-                               && init_value->getType()->isIntegerTy())
-                    {
-                        init_value = context.m_BUILDER.CreateSIToFP(init_value, type_info->llvm_type);
-                    } else if (type_info->kind == core::TypeKind::INT
-                               && init_value->getType()->isFloatingPointTy())
+                    if (type_info->is_numeric()
+                        && (init_value->getType()->isIntegerTy()
+                            || init_value->getType()->isFloatingPointTy()))
                     {
-                        init_value = context.m_BUILDER.CreateFPToSI(init_value, type_info->llvm_type);
+                        init_value = context.convert_scalar(init_value,
+                                                            context.is_unsigned(ast_node.list[2]),
+                                                            type_info->llvm_type,
+                                                            type_info->is_unsigned);
                     } else if (type_info->kind == core::TypeKind::BOOL
                                && init_value->getType()->isIntegerTy())
                     {
@@ -178,7 +192,7 @@ namespace galluz::generators {
                 context.m_MODULE.getOrInsertGlobal(var_name, value_type);
                 auto* variable = context.m_MODULE.getNamedGlobal(var_name);
 
-                variable->setAlignment(llvm::MaybeAlign(8));
+                variable->setAlignment(context.memory_alignment(value_type, type_info));
                 variable->setConstant(false);
                 variable->setInitializer(const_init);
 
@@ -190,7 +204,7 @@ namespace galluz::generators {
                     context.add_variable(var_name, init_value, value_type, type_info, false);
                     return init_value;
                 } else {
-                    auto* alloca = context.m_BUILDER.CreateAlloca(value_type, nullptr, var_name);
+                    auto* alloca = context.create_entry_alloca(value_type, var_name);
                     context.m_BUILDER.CreateStore(init_value, alloca);
 
                     context.add_variable(var_name, alloca, value_type, type_info, false);
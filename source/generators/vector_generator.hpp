@@ -0,0 +1,272 @@
+#pragma once
+
+#include <unordered_set>
+
+#include <llvm/IR/Instructions.h>
+
+#include "../core/generator_manager.hpp"
+#include "../core/types.hpp"
+#include "../logger.hpp"
+
+namespace galluz::generators {
+
+    /**
+     * @brief SIMD builtins on the v<lanes><element> types
+     *
+     * (vec !v4f64 a b c d)     one value per lane
+     * (splat !v4f64 x)         x in every lane
+     * (extract v i)            lane i, widened to int or double
+     * (insert v i x)           copy of v with lane i set to x
+     * (shuffle a [b] i ...)    lanes picked by constant indices from a, or from a followed by b
+     * (reduce-add v)           sum of the lanes; reduce-min and reduce-max likewise
+     * (select mask a b)        lane-wise a where mask is set, b elsewhere
+     *
+     * Arithmetic and comparisons on vectors are lane-wise (see ArithmeticGenerator and
+     * ComparisonGenerator); comparisons produce masks.
+     */
+    class VectorGenerator : public core::ICodeGenerator {
+      private:
+        core::GeneratorManager* m_GENERATOR_MANAGER;
+
+        inline static const std::unordered_set<std::string> BUILTINS = {"vec",
+                                                                         "splat",
+                                                                         "extract",
+                                                                         "insert",
+                                                                         "shuffle",
+                                                                         "reduce-add",
+                                                                         "reduce-min",
+                                                                         "reduce-max",
+                                                                         "select"};
+
+        auto parse_vector_type(const Exp& type_exp, core::CompilationContext& context)
+            -> llvm::FixedVectorType* {
+            auto* type = context.type_system->parse_type_spec(type_exp);
+            if (!type || type->kind != core::TypeKind::VECTOR) {
+                LOG_CRITICAL("Expected a vector type such as !v4f64, got %s", type_exp.string);
+            }
+            return llvm::cast<llvm::FixedVectorType>(type->llvm_type);
+        }
+
+        auto generate_vector(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            const std::string& name = ast_node.list[0].string;
+
+            llvm::Value* vector = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
+            if (!vector->getType()->isVectorTy()) {
+                LOG_CRITICAL("%s expects a vector as its first operand", name);
+            }
+            return vector;
+        }
+
+        auto generate_literal(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() < 2) {
+                LOG_CRITICAL("Invalid vec: (vec !type lane ...)");
+            }
+
+            auto* type = parse_vector_type(ast_node.list[1], context);
+            const size_t lanes = type->getNumElements();
+            if (ast_node.list.size() - 2 != lanes) {
+                LOG_CRITICAL("vec of %s needs %s values, got %s",
+                             ast_node.list[1].string,
+                             std::to_string(lanes),
+                             std::to_string(ast_node.list.size() - 2));
+            }
+
+            llvm::Value* result = llvm::UndefValue::get(type);
+            for (size_t i = 0; i < lanes; ++i) {
+                llvm::Value* lane = m_GENERATOR_MANAGER->generate_code(ast_node.list[i + 2], context);
+                result = context.m_BUILDER.CreateInsertElement(
+                    result, context.to_lane(lane, type->getElementType()), static_cast<uint64_t>(i));
+            }
+            return result;
+        }
+
+        auto generate_splat(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() != 3) {
+                LOG_CRITICAL("Invalid splat: (splat !type value)");
+            }
+
+            auto* type = parse_vector_type(ast_node.list[1], context);
+            return context.splat(m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context), type);
+        }
+
+        auto generate_extract(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() != 3) {
+                LOG_CRITICAL("Invalid extract: (extract vector index)");
+            }
+
+            llvm::Value* vector = generate_vector(ast_node, context);
+            llvm::Value* index = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
+            if (!index->getType()->isIntegerTy()) {
+                LOG_CRITICAL("Lane index must be an integer");
+            }
+            return context.from_lane(context.m_BUILDER.CreateExtractElement(vector, index));
+        }
+
+        auto generate_insert(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() != 4) {
+                LOG_CRITICAL("Invalid insert: (insert vector index value)");
+            }
+
+            llvm::Value* vector = generate_vector(ast_node, context);
+            llvm::Value* index = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
+            if (!index->getType()->isIntegerTy()) {
+                LOG_CRITICAL("Lane index must be an integer");
+            }
+            llvm::Value* value = m_GENERATOR_MANAGER->generate_code(ast_node.list[3], context);
+
+            auto* element_type = llvm::cast<llvm::VectorType>(vector->getType())->getElementType();
+            return context.m_BUILDER.CreateInsertElement(vector, context.to_lane(value, element_type), index);
+        }
+
+        auto generate_shuffle(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() < 3) {
+                LOG_CRITICAL("Invalid shuffle: (shuffle a [b] index ...)");
+            }
+
+            llvm::Value* first = generate_vector(ast_node, context);
+            size_t next = 2;
+            llvm::Value* second = nullptr;
+            if (ast_node.list[2].type != ExpType::NUMBER) {
+                second = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
+                if (second->getType() != first->getType()) {
+                    LOG_CRITICAL("Both shuffle sources must be vectors of the same type");
+                }
+                next = 3;
+            }
+
+            const auto lanes = llvm::cast<llvm::FixedVectorType>(first->getType())->getNumElements();
+            const int limit = static_cast<int>(second ? 2 * lanes : lanes);
+
+            std::vector<int> mask;
+            for (size_t i = next; i < ast_node.list.size(); ++i) {
+                const auto& index = ast_node.list[i];
+                if (index.type != ExpType::NUMBER || index.number < 0 || index.number >= limit) {
+                    LOG_CRITICAL("Shuffle indices must be integer literals from 0 to %s",
+                                 std::to_string(limit - 1));
+                }
+                mask.push_back(static_cast<int>(index.number));
+            }
+            if (mask.empty()) {
+                LOG_CRITICAL("Shuffle needs at least one index");
+            }
+
+            if (!second) {
+                return context.m_BUILDER.CreateShuffleVector(first, mask);
+            }
+            return context.m_BUILDER.CreateShuffleVector(first, second, mask);
+        }
+
+        /**
+         * @brief Horizontal reduction through the llvm.vector.reduce.* intrinsics
+         *
+         * A floating point sum may be reassociated so that it lowers to a log2(lanes) tree of
+         * vector adds rather than a lane-by-lane chain.
+         */
+        auto generate_reduce(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            const std::string& name = ast_node.list[0].string;
+            if (ast_node.list.size() != 2) {
+                LOG_CRITICAL("Invalid %s: (%s vector)", name, name);
+            }
+
+            auto& builder = context.m_BUILDER;
+            llvm::Value* vector = generate_vector(ast_node, context);
+            const bool is_int = vector->getType()->isIntOrIntVectorTy();
+
+            llvm::Value* result = nullptr;
+            if (name == "reduce-add") {
+                if (is_int) {
+                    result = builder.CreateAddReduce(vector);
+                } else {
+                    auto* element_type = llvm::cast<llvm::VectorType>(vector->getType())->getElementType();
+                    auto* sum =
+                        builder.CreateFAddReduce(llvm::ConstantFP::getNegativeZero(element_type), vector);
+                    llvm::cast<llvm::Instruction>(sum)->setHasAllowReassoc(true);
+                    result = sum;
+                }
+            } else if (name == "reduce-min") {
+                result = is_int ? builder.CreateIntMinReduce(vector, true)
+                                : builder.CreateFPMinReduce(vector);
+            } else {
+                result = is_int ? builder.CreateIntMaxReduce(vector, true)
+                                : builder.CreateFPMaxReduce(vector);
+            }
+
+            return context.from_lane(result);
+        }
+
+        auto generate_select(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* {
+            if (ast_node.list.size() != 4) {
+                LOG_CRITICAL("Invalid select: (select mask a b)");
+            }
+
+            llvm::Value* mask = m_GENERATOR_MANAGER->generate_code(ast_node.list[1], context);
+            llvm::Value* on_true = m_GENERATOR_MANAGER->generate_code(ast_node.list[2], context);
+            llvm::Value* on_false = m_GENERATOR_MANAGER->generate_code(ast_node.list[3], context);
+
+            auto* mask_type = llvm::dyn_cast<llvm::FixedVectorType>(mask->getType());
+            if (!mask_type || !mask_type->getElementType()->isIntegerTy(1)) {
+                LOG_CRITICAL("select expects a mask vector, e.g. the result of a vector comparison");
+            }
+
+            auto* vector_type = llvm::dyn_cast<llvm::FixedVectorType>(on_true->getType());
+            if (!vector_type) {
+                vector_type = llvm::dyn_cast<llvm::FixedVectorType>(on_false->getType());
+            }
+            if (!vector_type || vector_type->getNumElements() != mask_type->getNumElements()) {
+                LOG_CRITICAL("select operands must be vectors with as many lanes as the mask");
+            }
+
+            if (!on_true->getType()->isVectorTy()) {
+                on_true = context.splat(on_true, vector_type);
+            }
+            if (!on_false->getType()->isVectorTy()) {
+                on_false = context.splat(on_false, vector_type);
+            }
+            if (on_true->getType() != on_false->getType()) {
+                LOG_CRITICAL("select operands must be vectors of the same type");
+            }
+
+            return context.m_BUILDER.CreateSelect(mask, on_true, on_false);
+        }
+
+      public:
+        explicit VectorGenerator(core::GeneratorManager* manager)
+            : m_GENERATOR_MANAGER(manager) {}
+
+        auto can_handle(const Exp& ast_node) const -> bool override {
+            return ast_node.type == ExpType::LIST && !ast_node.list.empty()
+                && ast_node.list[0].type == ExpType::SYMBOL && BUILTINS.count(ast_node.list[0].string);
+        }
+
+        auto generate(const Exp& ast_node, core::CompilationContext& context) -> llvm::Value* override {
+            const std::string& name = ast_node.list[0].string;
+
+            if (name == "vec") {
+                return generate_literal(ast_node, context);
+            }
+            if (name == "splat") {
+                return generate_splat(ast_node, context);
+            }
+            if (name == "select") {
+                return generate_select(ast_node, context);
+            }
+
+            if (ast_node.list.size() < 2) {
+                LOG_CRITICAL("%s expects a vector operand", name);
+            }
+            if (name == "extract") {
+                return generate_extract(ast_node, context);
+            }
+            if (name == "insert") {
+                return generate_insert(ast_node, context);
+            }
+            if (name == "shuffle") {
+                return generate_shuffle(ast_node, context);
+            }
+            return generate_reduce(ast_node, context);
+        }
+
+        auto get_priority() const -> int override { return 450; }
+    };
+
+}    // namespace galluz::generators
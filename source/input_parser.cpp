@@ -70,6 +70,20 @@ auto InputParser::get_argument(const std::string& name) const -> std::optional<s
     return it->second;
 }
 
+auto InputParser::get_arguments(const std::string& name) const -> std::vector<std::string> {
+    const auto idx = get_option_index(name);
+    if (!idx) {
+        return {};
+    }
+
+    const auto it = m_PARSED_LISTS.find(*idx);
+    if (it == m_PARSED_LISTS.end()) {
+        return {};
+    }
+
+    return it->second;
+}
+
 auto InputParser::get_positional_args() const -> const std::vector<std::string>& {
     return m_POSITIONAL_ARGS;
 }
@@ -135,6 +149,7 @@ auto InputParser::is_option_registered(const std::string& name) const -> bool {
 
 auto InputParser::reset_state() -> void {
     m_PARSED_VALUES.clear();
+    m_PARSED_LISTS.clear();
     m_POSITIONAL_ARGS.clear();
     m_ERRORS.clear();
 }
@@ -156,6 +171,7 @@ auto InputParser::handle_equals_syntax(const std::string& token) -> void {
         const auto& option = m_OPTIONS[it->second];
         if (option.requires_argument) {
             m_PARSED_VALUES[it->second] = value;
+            m_PARSED_LISTS[it->second].push_back(value);
         } else {
             m_ERRORS.push_back("Option " + key + " doesn't accept arguments");
         }
@@ -189,6 +205,7 @@ auto InputParser::handle_regular_option(const std::string& token, int& index, in
             m_ERRORS.push_back("Missing argument for: " + token);
         } else {
             m_PARSED_VALUES[*idx] = argv[++index];
+            m_PARSED_LISTS[*idx].push_back(m_PARSED_VALUES[*idx]);
             advance_index = false;    // Already advanced index
         }
     } else {
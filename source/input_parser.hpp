@@ -69,6 +69,14 @@ class InputParser {
      */
     auto get_argument(const std::string& name) const -> std::optional<std::string>;
 
+    /**
+     * @brief Get every argument given for a repeatable option, in command line order
+     *
+     * @param name Short or long option name
+     * @return std::vector<std::string> Argument values (empty if option is absent)
+     */
+    auto get_arguments(const std::string& name) const -> std::vector<std::string>;
+
     /**
      * @brief Get positional arguments
      *
@@ -106,6 +114,7 @@ class InputParser {
     std::map<std::string, size_t> m_SHORT_MAP;    ///< Short name to index mapping
     std::map<std::string, size_t> m_LONG_MAP;    ///< Long name to index mapping
     std::map<size_t, std::string> m_PARSED_VALUES;    ///< Parsed option values
+    std::map<size_t, std::vector<std::string>> m_PARSED_LISTS;    ///< All values of repeated options
     std::vector<std::string> m_POSITIONAL_ARGS;    ///< Positional arguments
     std::vector<std::string> m_ERRORS;    ///< Parsing errors
 };
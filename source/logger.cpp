@@ -4,6 +4,7 @@
 #include "logger.hpp"
 
 thread_local std::vector<std::pair<std::string, std::string>> Logger::expression_stack_;
+thread_local std::string* Logger::capture_sink_ = nullptr;
 
 void Logger::push_expression(const std::string& context, const std::string& expr) {
     expression_stack_.emplace_back(context, expr);
@@ -12,12 +13,30 @@ void Logger::push_expression(const std::string& context, const std::string& expr
     }
 }
 
+void Logger::clear_expressions() {
+    expression_stack_.clear();
+}
+
+void Logger::capture_output(std::string* sink) {
+    capture_sink_ = sink;
+}
+
+void Logger::write(FILE* stream, const std::string& text) {
+    if (capture_sink_ != nullptr) {
+        capture_sink_->append(text);
+        return;
+    }
+
+    std::fputs(text.c_str(), stream);
+    std::fflush(stream);
+}
+
 void Logger::print_traceback() {
     if (expression_stack_.empty()) {
         return;
     }
 
-    std::fprintf(stderr, "%sExpressions traceback:%s\n", BOLD, RESET_STYLE);
+    write(stderr, format_message("%sExpressions traceback:%s\n", BOLD, RESET_STYLE));
 
     size_t start =
         expression_stack_.size() > TRACEBACK_LIMIT ? expression_stack_.size() - TRACEBACK_LIMIT : 0;
@@ -25,7 +44,7 @@ void Logger::print_traceback() {
     for (size_t i = start; i < expression_stack_.size(); ++i) {
         const auto& [ctx, expr] = expression_stack_[i];
 
-        std::fprintf(stderr, "%-5d|    %s%-8s%s %s\n", i, CYAN_COLOR, ctx.c_str(), RESET_STYLE, expr.c_str());
+        write(stderr, format_message("%-5zu|    %s%-8s%s %s\n", i, CYAN_COLOR, ctx, RESET_STYLE, expr));
     }
 }
 
@@ -65,14 +84,13 @@ void Logger::print_log(Level level, const std::string& message) {
             break;
     }
 
-    std::fprintf(stream,
-                 "%s[galluzLLVM :: %s%s%-8s%s]%s %s\n",
-                 BOLD,
-                 BOLD,
-                 color,
-                 level_str,
-                 RESET_STYLE,
-                 RESET_STYLE,
-                 message.c_str());
-    std::fflush(stream);
+    write(stream,
+          format_message("%s[galluzLLVM :: %s%s%-8s%s]%s %s\n",
+                         BOLD,
+                         BOLD,
+                         color,
+                         level_str,
+                         RESET_STYLE,
+                         RESET_STYLE,
+                         message));
 }
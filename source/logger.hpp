@@ -9,6 +9,16 @@
 
 #include "_default.hpp"
 
+/**
+ * @brief Thrown by LOG_CRITICAL: the current compilation cannot continue
+ *
+ * The message has already been logged together with the expression traceback.
+ */
+class CompileError : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+};
+
 class Logger {
   public:
     enum class Level
@@ -28,7 +38,7 @@ class Logger {
 
         if (level == Level::CRITICAL) {
             print_traceback();
-            std::exit(EXIT_FAILURE);
+            throw CompileError(formatted);
         }
     }
 
@@ -38,12 +48,19 @@ class Logger {
     }
 
     static void push_expression(const std::string& context, const std::string& expr);
+    static void clear_expressions();
     static void print_traceback();
 
+    /**
+     * @brief Collect this thread's log output into @p sink instead of stdout/stderr (nullptr to stop)
+     */
+    static void capture_output(std::string* sink);
+
   private:
     static const constexpr size_t MAX_STACK_SIZE = 100;
     static const constexpr size_t TRACEBACK_LIMIT = 15;
     static thread_local std::vector<std::pair<std::string, std::string>> expression_stack_;
+    static thread_local std::string* capture_sink_;
 
     template<typename T>
     static auto format_arg(T arg) -> T {
@@ -70,6 +87,7 @@ class Logger {
     }
 
     static void print_log(Level level, const std::string& message);
+    static void write(FILE* stream, const std::string& text);
 };
 
 #define LOG_NOTE(...) Logger::log(Logger::Level::NOTE, __VA_ARGS__)
@@ -1,15 +1,24 @@
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "compile_server.hpp"
 #include "core/compiler.hpp"
+#include "core/lazy_jit.hpp"
+#include "core/library_builder.hpp"
+#include "core/optimizer.hpp"
+#include "core/parallel_backend.hpp"
+#include "core/repl.hpp"
 #include "input_parser.hpp"
 #include "logger.hpp"
 
@@ -57,45 +66,158 @@ namespace {
     }
 
     /**
-     * @brief Compile generated IR to binary
+     * @brief Optimize the generated module in-process and save it next to the raw IR
      */
-    auto compile_ir(const std::string& output_base) -> bool {
-        const std::string ll_file = output_base + ".ll";
+    auto optimize_ir(llvm::Module& module, galluz::core::Optimizer& optimizer, const std::string& output_base)
+        -> bool {
         const std::string opt_ll_file = output_base + "-opt.ll";
-        const std::string bin_file = output_base;
-
-        if (!fs::exists(ll_file)) {
-            LOG_ERROR("IR code not found");
-            return false;
-        }
-
-        std::string opt_cmd = "opt " + safe_path(ll_file) + " -O3 -S -o " + safe_path(opt_ll_file);
 
         LOG_INFO("Optimizing code...");
 
-        if (execute_command(opt_cmd) != 0) {
-            LOG_ERROR("Code optimization failed");
-            std::cout << "Command: " << opt_cmd << "\n";
-            execute_command(opt_cmd, false);
+        optimizer.run(module);
+
+        std::error_code err_code;
+        llvm::raw_fd_ostream out_file(opt_ll_file, err_code);
+        if (err_code) {
+            LOG_ERROR(
+                "Cannot write optimized IR \"%s\": %s", opt_ll_file.c_str(), err_code.message().c_str());
             return false;
         }
+        module.print(out_file, nullptr);
+        out_file.close();
 
         if (!fs::exists(opt_ll_file) || fs::file_size(opt_ll_file) == 0) {
             LOG_ERROR("Optimized IR code not created");
             return false;
         }
 
-        std::string clang_cmd = "clang++ -O3 " + safe_path(opt_ll_file) + " -o " + safe_path(bin_file);
+        return true;
+    }
 
-        LOG_INFO("Compiling optimized code...");
+    /**
+     * @brief What a compilation writes
+     */
+    enum class EmitKind : uint8_t
+    {
+        BINARY,
+        OBJECT,
+        BITCODE,
+        ASSEMBLY,
+        IR,
+        STATIC_LIBRARY,
+        SHARED_LIBRARY
+    };
 
-        if (execute_command(clang_cmd) != 0) {
-            LOG_ERROR("Binary compilation failed");
-            std::cout << "Command: " << clang_cmd << "\n";
-            execute_command(clang_cmd, false);
+    auto parse_emit_kind(const std::string& text) -> std::optional<EmitKind> {
+        if (text == "bin") {
+            return EmitKind::BINARY;
+        }
+        if (text == "obj") {
+            return EmitKind::OBJECT;
+        }
+        if (text == "bc") {
+            return EmitKind::BITCODE;
+        }
+        if (text == "asm") {
+            return EmitKind::ASSEMBLY;
+        }
+        if (text == "ll") {
+            return EmitKind::IR;
+        }
+        if (text == "staticlib") {
+            return EmitKind::STATIC_LIBRARY;
+        }
+        if (text == "sharedlib") {
+            return EmitKind::SHARED_LIBRARY;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Path of the artifact for output_base, which may already carry the extension
+     */
+    auto artifact_path(const std::string& output_base, EmitKind kind) -> std::string {
+        std::string extension;
+        switch (kind) {
+            case EmitKind::OBJECT:
+                extension = ".o";
+                break;
+            case EmitKind::BITCODE:
+                extension = ".bc";
+                break;
+            case EmitKind::ASSEMBLY:
+                extension = ".s";
+                break;
+            case EmitKind::IR:
+                extension = ".ll";
+                break;
+            case EmitKind::STATIC_LIBRARY:
+                extension = ".a";
+                break;
+            case EmitKind::SHARED_LIBRARY:
+                extension = ".so";
+                break;
+            case EmitKind::BINARY:
+                return output_base;
+        }
+
+        if (fs::path(output_base).extension() == extension) {
+            return output_base;
+        }
+        return output_base + extension;
+    }
+
+    /**
+     * @brief Optimize the module in-process and write it as an object, bitcode, assembly or IR file
+     *
+     * Nothing goes through textual IR or an external tool unless IR is what was asked for.
+     */
+    auto emit_artifact(llvm::Module& module,
+                       galluz::core::Optimizer& optimizer,
+                       EmitKind kind,
+                       const std::string& path) -> bool {
+        LOG_INFO("Optimizing code...");
+        optimizer.run(module);
+
+        if (kind == EmitKind::OBJECT) {
+            return optimizer.emit_object(module, path);
+        }
+        if (kind == EmitKind::ASSEMBLY) {
+            return optimizer.emit_object(module, path, llvm::CGFT_AssemblyFile);
+        }
+
+        std::error_code err_code;
+        llvm::raw_fd_ostream out_file(path, err_code, llvm::sys::fs::OF_None);
+        if (err_code) {
+            LOG_ERROR("Cannot write \"%s\": %s", path.c_str(), err_code.message().c_str());
             return false;
         }
 
+        if (kind == EmitKind::BITCODE) {
+            llvm::WriteBitcodeToFile(module, out_file);
+        } else {
+            module.print(out_file, nullptr);
+        }
+        return true;
+    }
+
+    auto is_library(EmitKind kind) -> bool {
+        return kind == EmitKind::STATIC_LIBRARY || kind == EmitKind::SHARED_LIBRARY;
+    }
+
+    /**
+     * @brief Run build commands in order and check that they produced the binary
+     */
+    auto run_build_commands(const std::vector<std::string>& commands, const std::string& bin_file) -> bool {
+        for (const auto& cmd : commands) {
+            if (execute_command(cmd) != 0) {
+                LOG_ERROR("Binary compilation failed");
+                LOG_ERROR("Command: %s", cmd.c_str());
+                execute_command(cmd, false);
+                return false;
+            }
+        }
+
         if (!fs::exists(bin_file) || fs::file_size(bin_file) == 0) {
             LOG_ERROR("Binary file \"%s\" not created", bin_file.c_str());
             return false;
@@ -104,10 +226,76 @@ namespace {
         return true;
     }
 
+    /**
+     * @brief Whether a --link-lib value names a file rather than a library to search for
+     */
+    auto is_library_path(const std::string& library) -> bool {
+        const auto extension = fs::path(library).extension();
+        return library.find('/') != std::string::npos || extension == ".a" || extension == ".so"
+            || extension == ".o";
+    }
+
+    /**
+     * @brief Linker arguments for --link-lib values: `-l<name>` for names, files as they are
+     */
+    auto link_flags(const std::vector<std::string>& libraries) -> std::string {
+        std::string flags;
+        for (const auto& library : libraries) {
+            flags += is_library_path(library) ? " " + safe_path(library) : " -l" + library;
+        }
+        return flags;
+    }
+
+    /**
+     * @brief Compile optimized IR to binary
+     *
+     * An instrumented module is compiled and linked in two steps so that clang++ only adds its
+     * profile runtime at link time instead of instrumenting the IR a second time.
+     */
+    auto compile_ir(const std::string& output_base, bool profile_generate, const std::string& libraries)
+        -> bool {
+        const std::string opt_ll_file = output_base + "-opt.ll";
+        const std::string obj_file = output_base + ".o";
+        const std::string bin_file = output_base;
+
+        std::vector<std::string> commands;
+        if (profile_generate) {
+            commands.push_back("clang++ -O3 -c " + safe_path(opt_ll_file) + " -o " + safe_path(obj_file));
+            commands.push_back("clang++ -fprofile-generate " + safe_path(obj_file) + " -o "
+                               + safe_path(bin_file) + libraries);
+        } else {
+            commands.push_back("clang++ -O3 " + safe_path(opt_ll_file) + " -o " + safe_path(bin_file)
+                               + libraries);
+        }
+
+        LOG_INFO("Compiling optimized code...");
+
+        return run_build_commands(commands, bin_file);
+    }
+
+    /**
+     * @brief Link objects emitted in-process into the binary
+     */
+    auto link_objects(const std::vector<std::string>& object_files,
+                      const std::string& output_base,
+                      bool profile_generate,
+                      const std::string& libraries) -> bool {
+        std::string command = profile_generate ? "clang++ -fprofile-generate" : "clang++";
+        for (const auto& object_file : object_files) {
+            command += " " + safe_path(object_file);
+        }
+        command += " -o " + safe_path(output_base) + libraries;
+
+        LOG_INFO("Linking %zu objects...", object_files.size());
+
+        return run_build_commands({command}, output_base);
+    }
+
     /**
      * @brief Safe cleanup of temporary files
      */
-    void cleanup_temp_files(const std::string& output_base) {
+    void cleanup_temp_files(const std::string& output_base,
+                            const std::vector<std::string>& object_files = {}) {
         auto safe_remove = [](const std::string& path)
         {
             try {
@@ -122,13 +310,17 @@ namespace {
 
         safe_remove(output_base + ".ll");
         safe_remove(output_base + "-opt.ll");
+        safe_remove(output_base + ".o");
+        for (const auto& object_file : object_files) {
+            safe_remove(object_file);
+        }
     }
 
     /**
      * @brief Check if all required utils are available
      */
     auto check_utils_available() -> bool {
-        const std::vector<std::string> REQUIRED_PROGS = {"opt", "clang++"};
+        const std::vector<std::string> REQUIRED_PROGS = {"clang++"};
 
         for (const auto& util : REQUIRED_PROGS) {
             if (!is_util_available(util)) {
@@ -151,149 +343,743 @@ namespace {
         return std::none_of(
             name.begin(), name.end(), [&](char c) { return FORBIDDEN_CHARS.find(c) != std::string::npos; });
     }
-}    // namespace
 
-auto main(int argc, char** argv) -> int {
-    const std::string VERSION = "0.8.0";
-
-    std::string program;
-    std::string output_base = "out";
-    bool compile_raw_object_file = false;
-    std::unique_ptr<galluz::Compiler> compiler;
-    std::string current_directory;
-
-    // Initialize parser with program info
-    InputParser parser(fs::path(argv[0]).filename().string(),
-                       "GalluzLLVM - Compiler for the Galluz programming language");
-
-    // Register command line options
-    parser.add_option({"-v", "--version", "Get version", false, ""});
-    parser.add_option({"-h", "--help", "Print this help message", false, ""});
-    parser.add_option({"-e", "--expression", "Expression to parse", true, "<expr>"});
-    parser.add_option({"-f", "--file", "File to parse", true, "<file>"});
-    parser.add_option({"-o", "--output", "Output binary name", true, "<name>"});
-    parser.add_option({"-k", "--keep", "Keep temporary files", false, ""});
-    parser.add_option({"-cof", "--compile-object-file", "Compile raw object file", false, ""});
-
-    // Parse command line
-    if (!parser.parse(argc, argv)) {
-        for (const auto& error : parser.get_errors()) {
-            LOG_ERROR("%s", error.c_str());
-        }
-        std::cerr << parser.generate_help() << "\n";
-        return 1;
+    /**
+     * @brief Resolve a command line path against the directory the command was issued from
+     */
+    auto resolve_path(const fs::path& working_dir, const std::string& path) -> std::string {
+        if (working_dir.empty() || fs::path(path).is_absolute()) {
+            return path;
+        }
+        return (working_dir / path).string();
     }
 
-    if (parser.has_option("-v")) {
-        LOG_INFO("Version: %s", VERSION.c_str());
-        return 0;
+    /**
+     * @brief Parse a positive count given on the command line
+     */
+    auto parse_count(const std::string& text) -> std::optional<size_t> {
+        try {
+            size_t parsed = 0;
+            const unsigned long count = std::stoul(text, &parsed);
+            if (parsed == text.size() && count > 0) {
+                return count;
+            }
+        } catch (const std::exception&) {
+        }
+        return std::nullopt;
     }
 
-    // Handle help option
-    if (parser.has_option("-h") || parser.has_option("--help")) {
-        std::cout << parser.generate_help() << "\n";
-        return 0;
-    }
+    const std::string VERSION = "0.8.0";
 
-    if (parser.has_option("-cof") || parser.has_option("--compile-object-file")) {
-        compile_raw_object_file = true;
-    }
+    auto make_input_parser(const std::string& program_name) -> InputParser {
+        InputParser parser(program_name, "GalluzLLVM - Compiler for the Galluz programming language");
+
+        // Register command line options
+        parser.add_option({"-v", "--version", "Get version", false, ""});
+        parser.add_option({"-h", "--help", "Print this help message", false, ""});
+        parser.add_option({"-e", "--expression", "Expression to parse", true, "<expr>"});
+        parser.add_option({"-f", "--file", "File to parse (repeat to compile several)", true, "<file>"});
+        parser.add_option(
+            {"-b", "--batch", "Compile every file listed in <list>, one per line", true, "<list>"});
+        parser.add_option({"-j", "--jobs", "Parallel compilations for several inputs", true, "<count>"});
+        parser.add_option({"-bt",
+                           "--backend-threads",
+                           "Optimize and compile in-process on <count> threads",
+                           true,
+                           "<count>"});
+        parser.add_option({"-r", "--repl", "Start an interactive session", false, ""});
+        parser.add_option(
+            {"-J", "--jit", "Run the program in-process, compiling functions on first call", false, ""});
+        parser.add_option(
+            {"-jt", "--jit-threads", "Background threads for --jit compilation", true, "<count>"});
+        parser.add_option({"-o", "--output", "Output binary name", true, "<name>"});
+        parser.add_option({"-k", "--keep", "Keep temporary files", false, ""});
+        parser.add_option({"-l",
+                           "--link-lib",
+                           "Link with a library, by name (m) or path; repeatable",
+                           true,
+                           "<lib>"});
+        parser.add_option({"-cof", "--compile-object-file", "Same as --emit=obj", false, ""});
+        parser.add_option({"-em",
+                           "--emit",
+                           "Write bin (default), obj, bc, asm, ll, staticlib or sharedlib",
+                           true,
+                           "<kind>"});
+        parser.add_option(
+            {"-nsw", "--no-signed-wrap", "Assume signed integer arithmetic never overflows", false, ""});
+        parser.add_option({"-lr",
+                           "--loop-remarks",
+                           "Report why loops were or were not vectorized or unrolled",
+                           false,
+                           ""});
+        parser.add_option({"-sl",
+                           "--struct-layout",
+                           "Report the size, alignment and padding of every struct",
+                           false,
+                           ""});
+        parser.add_option({"-pg",
+                           "--profile-generate",
+                           "Instrument the binary to write <output>-<pid>.profraw",
+                           false,
+                           ""});
+        parser.add_option(
+            {"-pu", "--profile-use", "Optimize with a merged llvm-profdata profile", true, "<file>"});
+        parser.add_option({"-S", "--server", "Serve compile requests on a Unix socket", true, "<socket>"});
+        parser.add_option(
+            {"-C", "--client", "Forward this command line to a compile server", true, "<socket>"});
 
-    // Handle output option
-    if (auto output = parser.get_argument("-o")) {
-        output_base = *output;
-    } else if (auto output = parser.get_argument("--output")) {
-        output_base = *output;
+        return parser;
     }
 
-    if (!is_valid_output_name(output_base)) {
-        LOG_ERROR("Invalid output name: %s", output_base.c_str());
-        return 1;
+    /**
+     * @brief Check whether a command line asks for server or client mode
+     */
+    auto is_server_option(const std::vector<std::string>& args) -> bool {
+        return std::any_of(args.begin(),
+                           args.end(),
+                           [](const std::string& arg)
+                           {
+                               for (const char* option : {"-S", "--server", "-C", "--client"}) {
+                                   const std::string name = option;
+                                   if (arg == name || arg.rfind(name + "=", 0) == 0) {
+                                       return true;
+                                   }
+                               }
+                               return false;
+                           });
     }
 
-    // Handle input source
-    std::string input_filename;
-    if (auto filename = parser.get_argument("-f")) {
-        input_filename = *filename;
+    /**
+     * @brief One program to compile and where its binary goes
+     */
+    struct CompileJob {
+        std::string source_name;    ///< Input as given on the command line, for messages
+        std::string program;
+        std::string current_directory;    ///< Directory imports are resolved against
+        std::string output_base;
+    };
+
+    /**
+     * @brief Options shared by every job of one invocation
+     */
+    struct BuildSettings {
+        galluz::core::OptimizerOptions optimizer_options;
+        bool no_signed_wrap = false;
+        /// Log the layout chosen for each struct (--struct-layout)
+        bool struct_layout = false;
+        bool keep_temp_files = false;
+        /// Split the module over this many threads for optimization and codegen (0: clang++ backend)
+        size_t backend_threads = 0;
+        EmitKind emit = EmitKind::BINARY;
+        /// --link-lib values: library names (m for libm) or paths to archives, objects and shared libraries
+        std::vector<std::string> link_libraries;
+    };
+
+    /**
+     * @brief Load a source file into a job that writes its binary to output_base
+     */
+    auto load_job(const std::string& path, const fs::path& working_dir, const std::string& output_base)
+        -> std::optional<CompileJob> {
+        const std::string input_filename = resolve_path(working_dir, path);
         if (!fs::exists(input_filename)) {
-            LOG_ERROR("File \"%s\" not found", input_filename.c_str());
-            return 1;
+            LOG_ERROR("File \"%s\" not found", path.c_str());
+            return std::nullopt;
         }
 
         std::ifstream program_file(input_filename);
         if (!program_file.is_open()) {
-            LOG_ERROR("Cannot open file \"%s\"", input_filename.c_str());
-            return 1;
+            LOG_ERROR("Cannot open file \"%s\"", path.c_str());
+            return std::nullopt;
         }
 
         std::stringstream buffer;
         buffer << program_file.rdbuf();
-        program = buffer.str();
 
-        if (program.empty()) {
-            LOG_ERROR("File \"%s\" is empty", input_filename.c_str());
-            return 1;
+        CompileJob job {path, buffer.str(), fs::path(input_filename).parent_path().string(), output_base};
+        if (job.program.empty()) {
+            LOG_ERROR("File \"%s\" is empty", path.c_str());
+            return std::nullopt;
+        }
+        if (job.current_directory.empty()) {
+            job.current_directory = ".";
         }
 
-        fs::path file_path(input_filename);
-        current_directory = file_path.parent_path().string();
-        if (current_directory.empty()) {
-            current_directory = ".";
+        return job;
+    }
+
+    /**
+     * @brief Read a --batch list: one source path per line, blank lines and `#` comments skipped
+     */
+    auto read_batch_list(const std::string& list_path, std::vector<std::string>& inputs) -> bool {
+        std::ifstream list_file(list_path);
+        if (!list_file.is_open()) {
+            LOG_ERROR("Cannot open batch list \"%s\"", list_path.c_str());
+            return false;
         }
 
-    } else if (auto expr = parser.get_argument("-e")) {
-        program = *expr;
+        std::string line;
+        while (std::getline(list_file, line)) {
+            const size_t begin = line.find_first_not_of(" \t\r");
+            if (begin == std::string::npos || line[begin] == '#') {
+                continue;
+            }
+            const size_t end = line.find_last_not_of(" \t\r");
+            inputs.push_back(line.substr(begin, end - begin + 1));
+        }
 
-        if (program.empty()) {
-            LOG_ERROR("Empty expression");
-            return 1;
+        return true;
+    }
+
+    /**
+     * @brief Write the imported modules as a static or shared library plus its C header
+     *
+     * The header lands next to the library, with the extension replaced by `.h`.
+     */
+    auto build_library(galluz::Compiler& compiler,
+                       galluz::core::Optimizer& optimizer,
+                       const BuildSettings& settings,
+                       const std::string& library_file,
+                       bool profile_generate) -> bool {
+        galluz::core::LibraryBuilder library(compiler.get_module(), compiler.get_module_manager());
+        if (!library.prepare()) {
+            return false;
+        }
+        if (library.get_exports().empty()) {
+            LOG_ERROR("Nothing to export, a library is built from the modules the program imports");
+            return false;
+        }
+
+        const std::string object_file = fs::path(library_file).replace_extension(".o").string();
+        if (!emit_artifact(compiler.get_module(), optimizer, EmitKind::OBJECT, object_file)) {
+            return false;
         }
 
-        current_directory = fs::current_path().string();
+        bool built = false;
+        if (settings.emit == EmitKind::STATIC_LIBRARY) {
+            built = galluz::core::LibraryBuilder::write_archive(object_file, library_file);
+        } else {
+            const std::string linker = profile_generate ? "clang++ -fprofile-generate" : "clang++";
+            const std::string command =
+                linker + " -shared " + safe_path(object_file) + " -o " + safe_path(library_file)
+                + link_flags(settings.link_libraries);
+            built = run_build_commands({command}, library_file);
+        }
 
-    } else {
-        LOG_ERROR("No input specified (use -e or -f)");
-        std::cerr << parser.generate_help() << "\n";
-        return 1;
+        if (!settings.keep_temp_files) {
+            fs::remove(object_file);
+        }
+
+        return built && library.write_header(fs::path(library_file).replace_extension(".h").string());
+    }
+
+    /**
+     * @brief Generate, optimize and link one program
+     */
+    auto compile_job(const CompileJob& job,
+                     const BuildSettings& settings,
+                     galluz::core::Optimizer& optimizer,
+                     std::ostream& out) -> bool {
+        const std::string& output_base = job.output_base;
+        const bool profile_generate =
+            settings.optimizer_options.profile_mode == galluz::core::ProfileMode::GENERATE;
+
+        try {
+            LOG_INFO("Executing program...");
+
+            galluz::Compiler compiler(job.current_directory);
+            compiler.set_assume_no_signed_wrap(settings.no_signed_wrap);
+            compiler.set_report_struct_layout(settings.struct_layout);
+
+            if (settings.emit != EmitKind::BINARY) {
+                compiler.set_library_mode(is_library(settings.emit));
+                compiler.generate(compiler.parse(compiler.preprocess(job.program)));
+                if (profile_generate) {
+                    optimizer.set_profile_file(output_base + "-%p.profraw");
+                }
+
+                const std::string artifact = artifact_path(output_base, settings.emit);
+                const bool written = is_library(settings.emit)
+                    ? build_library(compiler, optimizer, settings, artifact, profile_generate)
+                    : emit_artifact(compiler.get_module(), optimizer, settings.emit, artifact);
+                if (!written) {
+                    return false;
+                }
+
+                LOG_INFO("Successfully wrote %s", artifact.c_str());
+                return true;
+            }
+
+            compiler.execute(job.program, output_base);
+            out << "\n";
+
+            const std::string LL_FILE = output_base + ".ll";
+            if (!fs::exists(LL_FILE) || fs::file_size(LL_FILE) == 0) {
+                LOG_ERROR("IR generation failed, no output file");
+                return false;
+            }
+
+            const std::string profile_file = output_base + "-%p.profraw";
+            std::vector<std::string> object_files;
+            bool built = false;
+
+            if (settings.backend_threads > 0) {
+                auto options = settings.optimizer_options;
+                if (profile_generate) {
+                    options.profile_file = profile_file;
+                }
+
+                LOG_INFO("Optimizing and compiling on %zu backend threads...", settings.backend_threads);
+                object_files = galluz::core::ParallelBackend(options, settings.backend_threads)
+                                   .run(compiler.get_module(), output_base);
+                built = link_objects(
+                    object_files, output_base, profile_generate, link_flags(settings.link_libraries));
+            } else {
+                if (profile_generate) {
+                    optimizer.set_profile_file(profile_file);
+                }
+                built = optimize_ir(compiler.get_module(), optimizer, output_base)
+                    && compile_ir(output_base, profile_generate, link_flags(settings.link_libraries));
+            }
+
+            if (!built) {
+                LOG_ERROR("Compilation failed, temporary files retained for debugging");
+                return false;
+            }
+
+            // Cleanup temporary files
+            if (!settings.keep_temp_files) {
+                cleanup_temp_files(output_base, object_files);
+            } else {
+                LOG_INFO("Optimized IR code saved: %s", LL_FILE.c_str());
+            }
+
+            LOG_INFO("Successfully compiled to %s", output_base.c_str());
+        } catch (const CompileError&) {
+            // Already reported with its expression traceback
+            return false;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Fatal error: %s", e.what());
+            return false;
+        }
+
+        return true;
     }
 
-    // Check required utilities
-    if (!check_utils_available()) {
+    /**
+     * @brief Compile independent programs on a pool of worker threads
+     *
+     * Each worker keeps one optimizer (and its target machine) for all of its jobs; parse tables
+     * and imported modules are shared process-wide. A job's log is buffered and printed in one
+     * piece, in full only when the job failed.
+     */
+    auto compile_batch(const std::vector<CompileJob>& jobs,
+                       const BuildSettings& settings,
+                       size_t thread_count,
+                       std::ostream& out) -> int {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        std::atomic<size_t> next_job {0};
+        std::atomic<size_t> failed_jobs {0};
+        std::mutex out_mutex;
+
+        auto worker = [&]()
+        {
+            galluz::core::Optimizer optimizer(settings.optimizer_options);
+            std::string log;
+            Logger::capture_output(&log);
+
+            for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+                log.clear();
+                Logger::clear_expressions();
+
+                std::ostringstream job_out;
+                const bool compiled = compile_job(jobs[i], settings, optimizer, job_out);
+                if (compiled) {
+                    log.clear();
+                    LOG_INFO("%s -> %s",
+                             jobs[i].source_name.c_str(),
+                             artifact_path(jobs[i].output_base, settings.emit).c_str());
+                } else {
+                    failed_jobs++;
+                    LOG_ERROR("%s failed", jobs[i].source_name.c_str());
+                }
+
+                std::lock_guard<std::mutex> lock(out_mutex);
+                out << log << std::flush;
+            }
+
+            Logger::capture_output(nullptr);
+        };
+
+        thread_count = std::max<size_t>(1, std::min(thread_count, jobs.size()));
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < thread_count; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+
+        const size_t failed = failed_jobs.load();
+        if (failed > 0) {
+            LOG_ERROR("%zu of %zu programs failed to compile", failed, jobs.size());
+            return 1;
+        }
+
+        LOG_INFO("Compiled %zu programs", jobs.size());
+        return 0;
+    }
+
+    /**
+     * @brief Execute the single job of a --jit invocation and return the program's exit code
+     */
+    auto run_jit(const std::vector<CompileJob>& jobs,
+                 const BuildSettings& settings,
+                 const InputParser& parser,
+                 const fs::path& working_dir) -> int {
+        if (!working_dir.empty()) {
+            LOG_ERROR("--jit cannot run through a compile server");
+            return 1;
+        }
+        if (jobs.size() != 1) {
+            LOG_ERROR("--jit runs exactly one program");
+            return 1;
+        }
+        if (settings.optimizer_options.profile_mode == galluz::core::ProfileMode::GENERATE) {
+            LOG_ERROR("--profile-generate needs a compiled binary, it cannot be combined with --jit");
+            return 1;
+        }
+
+        size_t compile_threads = 0;
+        if (auto threads_arg = parser.get_argument("-jt")) {
+            auto count = parse_count(*threads_arg);
+            if (!count) {
+                LOG_ERROR("Invalid JIT thread count: %s", threads_arg->c_str());
+                return 1;
+            }
+            compile_threads = *count;
+        }
+
+        try {
+            galluz::LazyJit jit(settings.optimizer_options, static_cast<unsigned>(compile_threads));
+            for (const auto& library : settings.link_libraries) {
+                std::string error;
+                if (is_library_path(library)) {
+                    if (!jit.load_library(library, error)) {
+                        LOG_ERROR("Cannot load %s: %s", library.c_str(), error.c_str());
+                        return 1;
+                    }
+                } else if (!jit.load_library("lib" + library + ".so", error)) {
+                    // e.g. libm.so is a linker script; its symbols are usually in the process already
+                    LOG_DEBUG("Library %s not loaded, resolving from the process: %s",
+                              library.c_str(),
+                              error.c_str());
+                }
+            }
+            return jit.run(jobs.front().program,
+                           jobs.front().current_directory,
+                           settings.no_signed_wrap,
+                           settings.struct_layout);
+        } catch (const CompileError&) {
+            // Already reported with its expression traceback
+        } catch (const std::exception& e) {
+            LOG_ERROR("Fatal error: %s", e.what());
+        }
         return 1;
     }
 
-    // Execute compilation pipeline
-    try {
-        LOG_INFO("Executing program...");
+    /**
+     * @brief Run one compiler invocation
+     *
+     * @param args Command line without the program name
+     * @param working_dir Directory relative paths are resolved against (empty: the process directory)
+     * @param out Stream for help text and other non-log output
+     */
+    auto run_compiler(const std::string& program_name,
+                      const std::vector<std::string>& args,
+                      const fs::path& working_dir,
+                      std::ostream& out) -> int {
+        std::string output_base = "out";
+        BuildSettings settings;
+
+        InputParser parser = make_input_parser(program_name);
 
-        compiler = std::make_unique<galluz::Compiler>(current_directory);
-        compiler->execute(program, output_base);
-        std::cout << "\n";
+        std::vector<std::string> argv_storage;
+        argv_storage.push_back(program_name);
+        argv_storage.insert(argv_storage.end(), args.begin(), args.end());
+        std::vector<char*> argv;
+        for (auto& arg : argv_storage) {
+            argv.push_back(arg.data());
+        }
 
-        const std::string LL_FILE = output_base + ".ll";
-        if (!fs::exists(LL_FILE) || fs::file_size(LL_FILE) == 0) {
-            LOG_ERROR("IR generation failed, no output file");
+        // Parse command line
+        if (!parser.parse(static_cast<int>(argv.size()), argv.data())) {
+            for (const auto& error : parser.get_errors()) {
+                LOG_ERROR("%s", error.c_str());
+            }
+            out << parser.generate_help() << "\n";
             return 1;
         }
 
-        if (!compile_ir(output_base)) {
-            LOG_ERROR("Compilation failed, temporary files retained for debugging");
+        if (parser.has_option("-v")) {
+            LOG_INFO("Version: %s", VERSION.c_str());
+            return 0;
+        }
+
+        // Handle help option
+        if (parser.has_option("-h") || parser.has_option("--help")) {
+            out << parser.generate_help() << "\n";
+            return 0;
+        }
+
+        if (parser.has_option("-cof") || parser.has_option("--compile-object-file")) {
+            settings.emit = EmitKind::OBJECT;
+        }
+        if (auto emit_arg = parser.get_argument("-em")) {
+            auto kind = parse_emit_kind(*emit_arg);
+            if (!kind) {
+                LOG_ERROR("Unknown --emit kind \"%s\" "
+                          "(expected bin, obj, bc, asm, ll, staticlib or sharedlib)",
+                          emit_arg->c_str());
+                return 1;
+            }
+            settings.emit = *kind;
+        }
+
+        settings.no_signed_wrap = parser.has_option("-nsw") || parser.has_option("--no-signed-wrap");
+        settings.struct_layout = parser.has_option("-sl") || parser.has_option("--struct-layout");
+        settings.keep_temp_files = parser.has_option("-k") || parser.has_option("--keep");
+        for (auto library : parser.get_arguments("-l")) {
+            if (is_library_path(library)) {
+                library = resolve_path(working_dir, library);
+            } else if (library.empty()
+                       || library.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                                    "0123456789_.+-")
+                           != std::string::npos)
+            {
+                LOG_ERROR("Invalid library name: %s", library.c_str());
+                return 1;
+            }
+            settings.link_libraries.push_back(library);
+        }
+
+        // Handle output option
+        auto output = parser.get_argument("-o");
+        if (output) {
+            output_base = *output;
+        }
+
+        if (!is_valid_output_name(output_base)) {
+            LOG_ERROR("Invalid output name: %s", output_base.c_str());
+            return 1;
+        }
+        output_base = resolve_path(working_dir, output_base);
+
+        auto& optimizer_options = settings.optimizer_options;
+        optimizer_options.loop_remarks = parser.has_option("-lr") || parser.has_option("--loop-remarks");
+        auto profile_use = parser.get_argument("-pu");
+
+        if (parser.has_option("-pg") || parser.has_option("--profile-generate")) {
+            if (profile_use) {
+                LOG_ERROR("--profile-generate and --profile-use are mutually exclusive");
+                return 1;
+            }
+            optimizer_options.profile_mode = galluz::core::ProfileMode::GENERATE;
+        } else if (profile_use) {
+            const std::string profile_file = resolve_path(working_dir, *profile_use);
+            if (!fs::exists(profile_file)) {
+                LOG_ERROR("Profile \"%s\" not found", profile_use->c_str());
+                return 1;
+            }
+            optimizer_options.profile_mode = galluz::core::ProfileMode::USE;
+            optimizer_options.profile_file = fs::absolute(profile_file).string();
+        }
+
+        if (parser.has_option("-r") || parser.has_option("--repl")) {
+            if (!working_dir.empty()) {
+                LOG_ERROR("--repl cannot run through a compile server");
+                return 1;
+            }
+            galluz::Repl repl(fs::current_path().string());
+            return repl.run();
+        }
+
+        // Handle input source
+        std::vector<std::string> inputs = parser.get_arguments("-f");
+        auto batch_list = parser.get_argument("-b");
+        if (batch_list && !read_batch_list(resolve_path(working_dir, *batch_list), inputs)) {
             return 1;
         }
 
-        // Cleanup temporary files
-        if (!parser.has_option("-k") && !parser.has_option("--keep")) {
-            cleanup_temp_files(output_base);
+        size_t thread_count = std::max(1U, std::thread::hardware_concurrency());
+        if (auto jobs_arg = parser.get_argument("-j")) {
+            auto count = parse_count(*jobs_arg);
+            if (!count) {
+                LOG_ERROR("Invalid job count: %s", jobs_arg->c_str());
+                return 1;
+            }
+            thread_count = *count;
+        }
+
+        if (auto backend_arg = parser.get_argument("-bt")) {
+            auto count = parse_count(*backend_arg);
+            if (!count) {
+                LOG_ERROR("Invalid backend thread count: %s", backend_arg->c_str());
+                return 1;
+            }
+            settings.backend_threads = *count;
+            if (settings.emit != EmitKind::BINARY) {
+                LOG_ERROR("--backend-threads only applies when building a binary");
+                return 1;
+            }
+        }
+
+        std::vector<CompileJob> jobs;
+        const bool batch = batch_list || inputs.size() > 1;
+        if (batch) {
+            if (output) {
+                LOG_ERROR("-o cannot be combined with several inputs, "
+                          "binaries are written next to their sources");
+                return 1;
+            }
+
+            for (const auto& input : inputs) {
+                auto job = load_job(input, working_dir, "");
+                if (!job) {
+                    return 1;
+                }
+                job->output_base = fs::path(resolve_path(working_dir, input)).replace_extension().string();
+                jobs.push_back(std::move(*job));
+            }
+
+            if (jobs.empty()) {
+                LOG_ERROR("Batch list \"%s\" has no inputs", batch_list->c_str());
+                return 1;
+            }
+        } else if (!inputs.empty()) {
+            auto job = load_job(inputs.front(), working_dir, output_base);
+            if (!job) {
+                return 1;
+            }
+            jobs.push_back(std::move(*job));
+        } else if (auto expr = parser.get_argument("-e")) {
+            if (expr->empty()) {
+                LOG_ERROR("Empty expression");
+                return 1;
+            }
+
+            const std::string current_directory =
+                working_dir.empty() ? fs::current_path().string() : working_dir.string();
+            jobs.push_back({"<expression>", *expr, current_directory, output_base});
         } else {
-            LOG_INFO("Optimized IR code saved: %s", LL_FILE.c_str());
+            LOG_ERROR("No input specified (use -e, -f or --batch)");
+            out << parser.generate_help() << "\n";
+            return 1;
+        }
+
+        if (parser.has_option("-J") || parser.has_option("--jit")) {
+            return run_jit(jobs, settings, parser, working_dir);
+        }
+
+        // Check required utilities
+        if ((settings.emit == EmitKind::BINARY || settings.emit == EmitKind::SHARED_LIBRARY)
+            && !check_utils_available())
+        {
+            return 1;
+        }
+
+        if (batch) {
+            return compile_batch(jobs, settings, thread_count, out);
+        }
+
+        // Execute compilation pipeline
+        galluz::core::Optimizer optimizer(optimizer_options);
+        return compile_job(jobs.front(), settings, optimizer, out) ? 0 : 1;
+    }
+
+    /**
+     * @brief Serve compile requests; LLVM targets and imported modules stay warm between them
+     */
+    auto run_server(const std::string& program_name, const std::string& socket_path) -> int {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        galluz::CompileServer server(
+            socket_path,
+            [&program_name](const galluz::CompileRequest& request, std::string& output) -> int
+            {
+                if (is_server_option(request.args)) {
+                    output += "Nested --server/--client requests are not supported\n";
+                    return 1;
+                }
+
+                Logger::capture_output(&output);
+                Logger::clear_expressions();
+
+                std::ostringstream out;
+                int exit_code = 1;
+                try {
+                    exit_code = run_compiler(program_name, request.args, request.working_directory, out);
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Fatal error: %s", e.what());
+                }
+
+                Logger::capture_output(nullptr);
+                output += out.str();
+                return exit_code;
+            });
+
+        return server.run();
+    }
+}    // namespace
+
+auto main(int argc, char** argv) -> int {
+    const std::string program_name = fs::path(argv[0]).filename().string();
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    InputParser parser = make_input_parser(program_name);
+    if (parser.parse(argc, argv)) {
+        if (auto socket_path = parser.get_argument("-S")) {
+            return run_server(program_name, *socket_path);
+        }
+        if (auto socket_path = parser.get_argument("--server")) {
+            return run_server(program_name, *socket_path);
+        }
+
+        auto socket_path = parser.get_argument("-C");
+        if (!socket_path) {
+            socket_path = parser.get_argument("--client");
+        }
+
+        if (socket_path) {
+            std::vector<std::string> forwarded;
+            for (size_t i = 0; i < args.size(); ++i) {
+                if (args[i] == "-C" || args[i] == "--client") {
+                    ++i;
+                } else if (args[i].rfind("-C=", 0) != 0 && args[i].rfind("--client=", 0) != 0) {
+                    forwarded.push_back(args[i]);
+                }
+            }
+
+            if (auto exit_code = galluz::forward_to_server(
+                    *socket_path, {fs::current_path().string(), forwarded}))
+            {
+                return *exit_code;
+            }
+
+            LOG_WARN("No compile server at \"%s\", compiling in this process", socket_path->c_str());
+            args = forwarded;
         }
+    }
 
-        LOG_INFO("Successfully compiled to %s", output_base.c_str());
+    try {
+        return run_compiler(program_name, args, {}, std::cout);
+    } catch (const CompileError&) {
+        return 1;
     } catch (const std::exception& e) {
-        LOG_ERROR("Fatal error");
-        std::cerr << e.what() << "\n";
+        LOG_ERROR("Fatal error: %s", e.what());
         return 1;
     }
-
-    return 0;
 }
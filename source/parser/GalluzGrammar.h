@@ -51,7 +51,10 @@
 //   }
 //
 // clang-format off
+#include <cerrno>
+#include <cstdlib>
 #include <string>
+#include <utility>
 #include <vector>
 
 enum class ExpType {
@@ -65,14 +68,22 @@ enum class ExpType {
 struct Exp {
     ExpType type;
 
-    int number;
+    /// Value of an integer literal; a u-suffixed one holds the bit pattern of its unsigned value
+    long long number;
     double fractional;
+    /// Contents of a string, name of a symbol, or the digits of an integer literal as written
     std::string string;
     std::vector<Exp> list;
+    /// Type suffix of a numeric literal (i8 ... i64, u8 ... u64, f32, f64), empty if it has none
+    std::string suffix;
+    /// The integer literal does not fit in 64 bits, or is negative with a u suffix
+    bool out_of_range = false;
 
-    Exp(int number) : type(ExpType::NUMBER), number(number) {}
+    Exp(long long number, std::string suffix)
+        : type(ExpType::NUMBER), number(number), suffix(std::move(suffix)) {}
 
-    Exp(double fractional) : type(ExpType::FRACTIONAL), fractional(fractional) {}
+    Exp(double fractional, std::string suffix)
+        : type(ExpType::FRACTIONAL), fractional(fractional), suffix(std::move(suffix)) {}
 
     Exp(std::string& str_value) {
         if (str_value[0] == '"') {
@@ -84,7 +95,32 @@ struct Exp {
         }
     }
 
-    Exp(std::vector<Exp> list) : type(ExpType::LIST), list(list) {}
+    Exp(std::vector<Exp> list) : type(ExpType::LIST), list(std::move(list)) {}
+
+    static auto literal_suffix(const std::string& literal) -> std::string {
+        const auto start = literal.find_first_of("iuf");
+        return start == std::string::npos ? "" : literal.substr(start);
+    }
+
+    /**
+     * Integer literal: u-suffixed ones may use the whole unsigned 64-bit range. A literal out of
+     * range is kept and reported when it is compiled, with the expression it appears in.
+     */
+    static auto integer_literal(const std::string& literal) -> Exp {
+        Exp exp(0LL, literal_suffix(literal));
+        exp.string = literal.substr(0, literal.size() - exp.suffix.size());
+
+        errno = 0;
+        if (!exp.suffix.empty() && exp.suffix[0] == 'u') {
+            const unsigned long long value = std::strtoull(exp.string.c_str(), nullptr, 10);
+            exp.number = static_cast<long long>(value);
+            exp.out_of_range = errno == ERANGE || (exp.string[0] == '-' && value != 0);
+        } else {
+            exp.number = std::strtoll(exp.string.c_str(), nullptr, 10);
+            exp.out_of_range = errno == ERANGE;
+        }
+        return exp;
+    }
 };
 
 using Value = Exp;    // clang-format on
@@ -225,15 +261,18 @@ enum class TokenType {
                 return toToken(TokenType::__EOF);
             }
 
-            auto strSlice = str_.substr(cursor_);
+            const auto sliceBegin = str_.cbegin() + cursor_;
 
-            auto lexRulesForState = lexRulesByStartConditions_.at(getCurrentState());
+            const auto& lexRulesForState = lexRulesByStartConditions_.at(getCurrentState());
 
             for (const auto& ruleIndex : lexRulesForState) {
-                auto rule = lexRules_[ruleIndex];
+                const auto& rule = lexRules_[ruleIndex];
                 std::smatch sm;
 
-                if (std::regex_search(strSlice, sm, rule.regex)) {
+                // Anchored at the cursor, so a failed rule costs O(1) instead of a scan of the rest
+                if (std::regex_search(
+                        sliceBegin, str_.cend(), sm, rule.regex, std::regex_constants::match_continuous))
+                {
                     yytext = sm[0];
 
                     captureLocations_(yytext);
@@ -261,7 +300,7 @@ enum class TokenType {
                 return toToken(TokenType::__EOF);
             }
 
-            throwUnexpectedToken(std::string(1, strSlice[0]), currentLine_, currentColumn_);
+            throwUnexpectedToken(std::string(1, str_[cursor_]), currentLine_, currentColumn_);
         }
 
         /**
@@ -459,10 +498,10 @@ std::array<LexRule, Tokenizer::LEX_RULES_COUNT> Tokenizer::lexRules_ = {{
   {std::regex(R"(^\/\/.*)"), &_lexRule3},
   {std::regex(R"(^\/\*[\s\S]*?\*\/)"), &_lexRule4},
   {std::regex(R"(^\s+)"), &_lexRule5},
-  {std::regex(R"(^[-+]?\d+\.\d*([eE][-+]?\d+)?)"), &_lexRule6},
-  {std::regex(R"(^[-+]?\.\d+([eE][-+]?\d+)?)"), &_lexRule7},
-  {std::regex(R"(^[-+]?\d+[eE][-+]?\d+)"), &_lexRule8},
-  {std::regex(R"(^[-+]?\d+)"), &_lexRule9},
+  {std::regex(R"(^[-+]?\d+\.\d*([eE][-+]?\d+)?(f32|f64)?)"), &_lexRule6},
+  {std::regex(R"(^[-+]?\.\d+([eE][-+]?\d+)?(f32|f64)?)"), &_lexRule7},
+  {std::regex(R"(^[-+]?\d+([eE][-+]?\d+(f32|f64)?|f32|f64))"), &_lexRule8},
+  {std::regex(R"(^[-+]?\d+([iu](8|16|32|64))?)"), &_lexRule9},
   {std::regex(R"(^"[^\"]*")"), &_lexRule10},
   {std::regex(R"(^[\w\-+*=!<>/:%]+)"), &_lexRule11},
   {std::regex(R"(^\.)"), &_lexRule12}
@@ -474,14 +513,14 @@ std::map<TokenizerState, std::vector<size_t>> Tokenizer::lexRulesByStartConditio
     // clang-format on
 
 #define POP_V() \
-    parser.valuesStack.back(); \
+    std::move(parser.valuesStack.back()); \
     parser.valuesStack.pop_back()
 
 #define POP_T() \
     parser.tokensStack.back(); \
     parser.tokensStack.pop_back()
 
-#define PUSH_VR() parser.valuesStack.push_back(__)
+#define PUSH_VR() parser.valuesStack.push_back(std::move(__))
 #define PUSH_TR() parser.tokensStack.push_back(__)
 
     /**
@@ -638,7 +677,7 @@ class GalluzGrammar {
 
                     // Pop the parsed value.
                     // clang-format off
-        auto result = valuesStack.back(); valuesStack.pop_back();
+        auto result = std::move(valuesStack.back()); valuesStack.pop_back();
                     // clang-format on
 
                     if (statesStack.size() != 1 || statesStack.back() != 0 || tokenizer.hasMoreTokens()) {
@@ -719,7 +758,7 @@ void _handler4(yyparse& parser) {
 // Semantic action prologue.
 auto _1 = POP_T();
 
-auto __ = Exp(std::stoi(_1)) ;
+auto __ = Exp::integer_literal(_1) ;
 
  // Semantic action epilogue.
 PUSH_VR();
@@ -730,7 +769,7 @@ void _handler5(yyparse& parser) {
 // Semantic action prologue.
 auto _1 = POP_T();
 
-auto __ = Exp(std::stod(_1)) ;
+auto __ = Exp(std::stod(_1), Exp::literal_suffix(_1)) ;
 
  // Semantic action epilogue.
 PUSH_VR();
@@ -788,7 +827,7 @@ void _handler10(yyparse& parser) {
 auto _2 = POP_V();
 auto _1 = POP_V();
 
-_1.list.push_back(_2); auto __ = _1 ;
+_1.list.push_back(std::move(_2)); auto __ = std::move(_1) ;
 
  // Semantic action epilogue.
 PUSH_VR();
@@ -34,9 +34,9 @@ auto safe_expr_to_string(const Exp& exp) -> std::string {
         case ExpType::SYMBOL:
             return exp.string;
         case ExpType::NUMBER:
-            return std::to_string(exp.number);
+            return std::to_string(exp.number) + exp.suffix;
         case ExpType::FRACTIONAL:
-            return std::to_string(exp.fractional);
+            return std::to_string(exp.fractional) + exp.suffix;
         case ExpType::STRING: {
             auto str1 = "\"" + exp.string + "\"";
             boost::replace_all(str1, "\n", "\\n");